@@ -0,0 +1,95 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile also has
+    a link to the code depository)
+*/
+
+// Count heap allocations for debugging
+#include"allocationCounter.h"
+
+#ifdef COUNT_ALLOCATIONS
+
+#include<atomic>
+#include<new>
+#include<cstdlib>
+
+static std::atomic<unsigned long> allocationCount(0);
+
+/* Replacements for the global allocation functions. The nothrow forms are
+    defined by the standard library in terms of these, so they are counted as
+    well. Sized delete is replaced too, so it frees with the same free() */
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    // malloc(0) may return NULL, which new may not
+    void* result = malloc(size ? size : 1);
+    if (result == 0)
+        throw std::bad_alloc();
+    return result;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    free(memory);
+}
+
+bool AllocationCounter::isEnabled(void)
+{
+    return true;
+}
+
+unsigned long AllocationCounter::getCount(void)
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+#else // Not counting
+
+bool AllocationCounter::isEnabled(void)
+{
+    return false;
+}
+
+unsigned long AllocationCounter::getCount(void)
+{
+    return 0;
+}
+
+#endif // COUNT_ALLOCATIONS
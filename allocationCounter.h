@@ -0,0 +1,42 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class counts heap allocations, to check that code which runs for
+    every record in the data files doesn't allocate memory. It works by
+    replacing the global operator new, which affects the entire program, so
+    it is only compiled in when COUNT_ALLOCATIONS is defined. Otherwise the
+    count is always zero */
+#ifndef ALLOCATION_COUNTER_H_INCLUDED
+#define ALLOCATION_COUNTER_H_INCLUDED
+
+class AllocationCounter
+{
+public:
+    // Returns true if allocations are being counted
+    static bool isEnabled(void);
+
+    /* Returns the number of allocations made by every thread since the program
+        started. Compare counts taken before and after the code of interest */
+    static unsigned long getCount(void);
+};
+
+#endif // ALLOCATION_COUNTER_H_INCLUDED
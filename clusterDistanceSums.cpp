@@ -0,0 +1,97 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+// Totals of the vote differences between clusters, kept as they merge
+#include<iostream>
+#include<vector>
+#include<algorithm>
+#include"congressData.h"
+#include"regionMapper.h"
+#include"clusterFactory.h"
+#include"clusterDistanceSums.h"
+
+using std::cerr;
+using std::endl;
+using std::vector;
+
+// Starts with every member in a cluster of their own
+ClusterDistanceSums::ClusterDistanceSums(const VoteDiffMatrix& memberDistances)
+    : _sums(), _clusterSizes(memberDistances.size(), 1), _liveClusters(memberDistances.size())
+{
+    unsigned short memberCount = memberDistances.size();
+    unsigned short row, column;
+    for (row = 0; row < memberCount; row++)
+        _liveClusters[row] = row;
+    if (memberCount < 2)
+        return;
+    _sums.resize(getOffset(memberCount - 1, 0) + memberCount - 1);
+    int64_t* sum = _sums.data();
+    for (row = 1; row < memberCount; row++) {
+        const short* distanceRow = memberDistances.getRow(row);
+        for (column = 0; column < row; column++)
+            *sum++ = distanceRow[column];
+    }
+}
+
+// Merges the second cluster into the first
+void ClusterDistanceSums::merge(unsigned short keptCluster, unsigned short mergedCluster)
+{
+    vector<unsigned short>::const_iterator live;
+    for (live = _liveClusters.begin(); live != _liveClusters.end(); live++)
+        if ((*live != keptCluster) && (*live != mergedCluster))
+            _sums[getOffset(*live, keptCluster)] += _sums[getOffset(*live, mergedCluster)];
+    _clusterSizes[keptCluster] += _clusterSizes[mergedCluster];
+    vector<unsigned short>::iterator merged = std::lower_bound(_liveClusters.begin(),
+                                                              _liveClusters.end(), mergedCluster);
+    if ((merged != _liveClusters.end()) && (*merged == mergedCluster))
+        _liveClusters.erase(merged);
+}
+
+/* Finds the average vote difference between every pair of groups, in the order
+    of the group list */
+void ClusterDistanceSums::getGroupDistances(const CongressGroupVector& groups,
+                                            VoteDiffMatrix& groupDistances) const
+{
+    if (groups.empty()) {
+        cerr << "Calculation of cluster distances failed, no clusters in list" << endl;
+        return;
+    }
+    groupDistances.assign(groups.size(), 0);
+
+    // A group is the cluster numbered by its lowest member
+    vector<unsigned short> clusters;
+    clusters.reserve(groups.size());
+    CongressGroupVector::const_iterator group;
+    for (group = groups.begin(); group != groups.end(); group++)
+        clusters.push_back(group->empty() ? 0 : group->getFirst());
+
+    unsigned short index1, index2;
+    for (index1 = 1; index1 < groups.size(); index1++) {
+        short* groupRow = groupDistances.getRow(index1);
+        for (index2 = 0; index2 < index1; index2++) {
+            /* Rounds the same way as the average found directly from the members, which
+                assumes the clusters are large enough for it not to matter */
+            int64_t pairCount = (int64_t)_clusterSizes[clusters[index1]] * _clusterSizes[clusters[index2]];
+            groupRow[index2] = (short)(_sums[getOffset(clusters[index1], clusters[index2])] / pairCount);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class keeps the total of the vote differences between the members of
+    every pair of clusters while they are merged. The graph needs the average
+    difference between each pair of groups once clustering stops. Finding it
+    afterwards means visiting every pair of members again, through the sets of
+    both groups. The total for a merged cluster is just the sum of the totals of
+    its two parts, so keeping them as clusters merge costs one pass over the
+    clusters per merge, and the averages are ready as soon as merging stops.
+
+    Clusters are numbered by their lowest member, the same as ClusterFactory,
+    and a merged cluster keeps the lower number of the two. Totals are kept in
+    64 bits; a pair of large clusters can pass the range of an int */
+#ifndef CLUSTER_DISTANCE_SUMS_H_INCLUDED
+#define CLUSTER_DISTANCE_SUMS_H_INCLUDED
+
+#include<vector>
+#include<cstdint>
+#include"voteDiffMatrix.h"
+
+/* NOTE: Uses CongressGroupVector from clusterFactory.h. The header is not included
+    here; callers need it anyway to do anything with the results */
+
+using std::vector;
+
+class ClusterDistanceSums
+{
+public:
+    // Starts with every member in a cluster of their own
+    explicit ClusterDistanceSums(const VoteDiffMatrix& memberDistances);
+
+    // Merges the second cluster into the first. Both must still exist
+    void merge(unsigned short keptCluster, unsigned short mergedCluster);
+
+    /* Finds the average vote difference between every pair of groups, in the order
+        of the group list. Each group must be one of the clusters merged here. The
+        result is the same as ClusterFactory::getClusterDistanceMap() */
+    void getGroupDistances(const CongressGroupVector& groups, VoteDiffMatrix& groupDistances) const;
+
+private:
+    vector<int64_t> _sums; // Packed lower triangle without the diagonal
+    vector<unsigned short> _clusterSizes;
+    vector<unsigned short> _liveClusters; // In order
+
+    // Location of the total for a pair of different clusters, in either order
+    static size_t getOffset(unsigned short cluster1, unsigned short cluster2);
+};
+
+inline size_t ClusterDistanceSums::getOffset(unsigned short cluster1, unsigned short cluster2)
+{
+    if (cluster1 < cluster2)
+        return (((size_t)cluster2 * (cluster2 - 1)) / 2) + cluster1;
+    else
+        return (((size_t)cluster1 * (cluster1 - 1)) / 2) + cluster2;
+}
+
+#endif // CLUSTER_DISTANCE_SUMS_H_INCLUDED
@@ -29,18 +29,25 @@
 #include<vector>
 #include<algorithm>
 #include<iomanip>
+#include<chrono>
+#include<memory>
+#include"allocationCounter.h"
 #include"congressData.h"
 #include"voteFactory.h" // Defines VoteDiffMatrix
 #include"regionMapper.h"
+#include"nearestNeighborChain.h"
+#include"rowMinimumMatrix.h"
 #include"clusterFactory.h"
+#include"dendrogram.h"
+#include"clusterDistanceSums.h"
 
 #define SCREEN_WIDTH 80
 
 using std::cerr;
 using std::endl;
 using std::vector;
-using std::multimap;
 using std::make_pair;
+using std::unique_ptr;
 
 // Ignore difference above this limit because their effect on the graph is too weak
 short ClusterFactory::meaningfulDifferenceLimit = 600;
@@ -49,43 +56,30 @@ short ClusterFactory::meaningfulDifferenceLimit = 600;
 GroupDistanceMap::GroupDistanceMap(const VoteDiffMatrix& distances)
 {
     /* Create a ragged array from the distances matrix. For every element
-        insert it in the multimap, and insert the resulting iterator into
+        insert it in the sorted set, and insert the resulting iterator into
         the array.
 
-        SEMI-HACK: This routine is very sensitive to inconsistencies in the
-        distance matrix. In particular, it assumes that it is square, and
-        reflective along the diagonal (so only half has to be read). This
-        routine should really check. Since the matrix was generated internally,
-        it just writes out warnings and inserts zeros for missing elements */
+        The distance matrix only stores the lower triangle, the same shape as
+        the ragged array, so each row is copied directly */
     vector<DistancePtr> newRow;
     unsigned short clusterCount = distances.size();
     if (clusterCount < 2) {
         cerr << "Cluster merge failed, initial distance data is empty" << endl;
         return; // Leave class empty, nothing to do!
     }
-    unsigned short clusterIndex1, clusterIndex2, rowSize;
+    unsigned short clusterIndex1, clusterIndex2;
     // First row is empty, will never be referenced
     _distanceByCluster.push_back(newRow);
     for (clusterIndex1 = 1; clusterIndex1 < clusterCount; clusterIndex1++) {
         _distanceByCluster.push_back(newRow);
-
-        // Find number of elements to process
-        rowSize = distances.at(clusterIndex1).size();
-        if (rowSize > clusterIndex1)
-            rowSize = clusterIndex1;
-
-        for (clusterIndex2 = 0; clusterIndex2 < rowSize; clusterIndex2++) {
+        _distanceByCluster.back().reserve(clusterIndex1);
+        const short* distanceRow = distances.getRow(clusterIndex1);
+        for (clusterIndex2 = 0; clusterIndex2 < clusterIndex1; clusterIndex2++) {
             // NOTE CAREFULLY: The swap of the indexes on insert, which makes the lower one appear first
-            DistancePtr sortedPtr = _sortedDistances.insert(make_pair(distances.at(clusterIndex1).at(clusterIndex2),
-                                                                      make_pair(clusterIndex2, clusterIndex1)));
-            _distanceByCluster.at(clusterIndex1).push_back(sortedPtr);
+            DistancePtr sortedPtr = _sortedDistances.insert(make_pair(distanceRow[clusterIndex2],
+                                                                      make_pair(clusterIndex2, clusterIndex1))).first;
+            _distanceByCluster.back().push_back(sortedPtr);
         } // For columns of given row
-        // Fill in missing values with zeroes
-        if (rowSize < clusterIndex1) {
-            cerr << "Cluster distance setup warning: Row " << clusterIndex1 << " not enough columns" << endl;
-            for (clusterIndex2 = rowSize; clusterIndex2 < clusterIndex1; clusterIndex2++)
-                _distanceByCluster.at(clusterIndex1).push_back(_sortedDistances.end());
-        } // Not enougn column values for all clusters
     } // For each row
 }
 
@@ -107,7 +101,7 @@ void GroupDistanceMap::updateDistance(unsigned short cluster1, unsigned short cl
                 << cluster1 << "," << cluster2 << ")" << endl;
         _sortedDistances.erase(_distanceByCluster.at(cluster1).at(cluster2));
         _distanceByCluster.at(cluster1).at(cluster2) =
-            _sortedDistances.insert(make_pair(distance, make_pair(cluster2, cluster1)));
+            _sortedDistances.insert(make_pair(distance, make_pair(cluster2, cluster1))).first;
     } // Distance defined for the cluster pair
 }
 
@@ -120,21 +114,95 @@ void ClusterFactory::formClusters(const VoteDiffMatrix& congressVotes,
                                   CongressGroupVector& congressMatchGroups,
                                   const CongressData& congressData, // Needed for trace
                                   short noiseThreshold, short minGroups,
-                                  bool traceOutput)
+                                  bool traceOutput, ClusterMethod method,
+                                  LinkageMatrix::Linkage linkage, Dendrogram* dendrogram,
+                                  VoteDiffMatrix* groupVotesMap)
 {
-    // Convert congresspeople into groups of one each
     congressMatchGroups.clear();
     // SANITY CHECK
     if (congressVotes.empty()) {
         cerr << "Grouping failed, matrix of vote differences is empty!" << endl;
         return;
     }
-    unsigned short clusterIndex;
-    for (clusterIndex = 0; clusterIndex < congressVotes.size(); clusterIndex++) {
-        CongressGroup newGroup;
-        newGroup.insert(clusterIndex);
-        congressMatchGroups.push_back(newGroup);
+    if (minGroups < 1)
+        minGroups = 1; // Ensure merge loop terminates
+
+    unique_ptr<ClusterDistanceSums> distanceSums;
+    if (groupVotesMap)
+        distanceSums.reset(new ClusterDistanceSums(congressVotes));
+
+    /* Sorted distances and row minimums only do complete linkage, and they stop merging
+        at the threshold, so they can't record the rest of the merges either */
+    if ((method == clusterNearestNeighborChain) || (linkage != LinkageMatrix::linkageComplete) ||
+            (dendrogram != 0)) {
+        Dendrogram ownDendrogram;
+        if (dendrogram == 0)
+            dendrogram = &ownDendrogram;
+        dendrogram->build(congressVotes, linkage);
+        dendrogram->cut(noiseThreshold, minGroups, congressMatchGroups, distanceSums.get());
+        if (traceOutput) {
+            size_t stepCount = dendrogram->getCutStepCount(noiseThreshold, minGroups);
+            size_t stepIndex;
+            for (stepIndex = 0; stepIndex < stepCount; stepIndex++) {
+                const Dendrogram::Step& step = dendrogram->getStep(stepIndex);
+                cerr << "Merge cluster " << step._cluster1 << " and " << step._cluster2
+                     << " at distance " << step._distance << endl;
+            }
+        }
+    } // Merges found by nearest neighbor chain
+    else {
+        // Convert congresspeople into groups of one each
+        unsigned short clusterIndex;
+        for (clusterIndex = 0; clusterIndex < congressVotes.size(); clusterIndex++) {
+            CongressGroup newGroup;
+            newGroup.insert(clusterIndex);
+            congressMatchGroups.push_back(newGroup);
+        }
+        if (method == clusterRowMinimums)
+            mergeByRowMinimums(congressVotes, congressMatchGroups, noiseThreshold, minGroups,
+                               traceOutput, distanceSums.get());
+        else
+            mergeBySortedDistances(congressVotes, congressMatchGroups, noiseThreshold, minGroups,
+                                   traceOutput, distanceSums.get());
+        removeEmptyGroups(congressMatchGroups);
+    }
+    if (groupVotesMap)
+        distanceSums->getGroupDistances(congressMatchGroups, *groupVotesMap);
+    if (traceOutput) {
+        cerr << "Final groups:" << endl;
+        debugOutputClusterList(congressMatchGroups, congressData);
     }
+}
+
+/* Removes the groups emptied by merging their members into others. The order of
+    the rest is the same every time for the same set of groups */
+void ClusterFactory::removeEmptyGroups(CongressGroupVector& congressMatchGroups)
+{
+    /* Since sets are removed as they are merged, the final vector may have holes in it
+        Go through the list and remove them. Since the final order has no meaning, search
+        from both ends to limit the number of swaps */
+    unsigned short fillIndex = 0;
+    while (fillIndex < congressMatchGroups.size()) {
+         // Eject all empty entries at the end of the vector
+        while ((fillIndex < congressMatchGroups.size()) &&
+               congressMatchGroups.back().empty())
+            congressMatchGroups.pop_back();
+       // Search forward for the first empty slot
+        while ((fillIndex < congressMatchGroups.size()) && (!congressMatchGroups.at(fillIndex).empty()))
+            fillIndex++;
+        if (fillIndex < congressMatchGroups.size()) // Found empty entry, swap to end
+            congressMatchGroups.at(fillIndex).swap(congressMatchGroups.back());
+    } // While not all entries in vector have been processed
+}
+
+/* Merges the closest pair of clusters until the closest pair is further apart than
+    the noise threshold, or the minimum number of groups is reached. Keeps every
+    distance sorted in a GroupDistanceMap to find the closest pair */
+void ClusterFactory::mergeBySortedDistances(const VoteDiffMatrix& congressVotes,
+                                            CongressGroupVector& congressMatchGroups,
+                                            short noiseThreshold, short minGroups,
+                                            bool traceOutput, ClusterDistanceSums* distanceSums)
+{
     GroupDistanceMap distances(congressVotes);
 
     if (traceOutput) {
@@ -142,19 +210,16 @@ void ClusterFactory::formClusters(const VoteDiffMatrix& congressVotes,
         debugOutputDistances(distances);
     }
 
-    if (minGroups < 1)
-        minGroups = 1; // Ensure merge loop terminates
-
     unsigned short clusterCount = distances.getClusterNoLimit();
     GroupDistanceMap::ClusterPair nextMerge = distances.getShortestDistanceCluster();
     short mergeDistance = distances.getDistance(nextMerge);
     while ((clusterCount > minGroups) && (mergeDistance <=  noiseThreshold)) {
         // Merge actual cluster contents
         unsigned short newCluster = findMergeClusterIndex(nextMerge.first, nextMerge.second);
-        if (nextMerge.first == newCluster)
-            mergeClusters(congressMatchGroups, nextMerge.second, newCluster);
-        else
-            mergeClusters(congressMatchGroups, nextMerge.first, newCluster);
+        unsigned short oldCluster = (nextMerge.first == newCluster) ? nextMerge.second : nextMerge.first;
+        mergeClusters(congressMatchGroups, oldCluster, newCluster);
+        if (distanceSums)
+            distanceSums->merge(newCluster, oldCluster);
         clusterCount--;
         // Merge the distance data, and find next cluster
         mergeClusters(distances, nextMerge.first, nextMerge.second);
@@ -167,26 +232,33 @@ void ClusterFactory::formClusters(const VoteDiffMatrix& congressVotes,
         nextMerge = distances.getShortestDistanceCluster();
         mergeDistance = distances.getDistance(nextMerge);
     } // while clusters to merge
+}
 
-    /* Since sets are removed as they are merged, the final vector may have holes in it
-        Go through the list and remove them. Since the final order has no meaning, search
-        from both ends to limit the number of swaps */
-    unsigned short fillIndex = 0;
-    while (fillIndex < congressMatchGroups.size()) {
-         // Eject all empty entries at the end of the vector
-        while ((fillIndex < congressMatchGroups.size()) &&
-               congressMatchGroups.back().empty())
-            congressMatchGroups.pop_back();
-       // Search forward for the first empty slot
-        while ((fillIndex < congressMatchGroups.size()) && (!congressMatchGroups.at(fillIndex).empty()))
-            fillIndex++;
-        if (fillIndex < congressMatchGroups.size()) // Found empty entry, swap to end
-            congressMatchGroups.at(fillIndex).swap(congressMatchGroups.back());
-    } // While not all entries in vector have been processed
-    if (traceOutput) {
-        cerr << "Final groups:" << endl;
-        debugOutputClusterList(congressMatchGroups, congressData);
-    }
+/* Merges the closest pair of clusters until the closest pair is further apart than
+    the noise threshold, or the minimum number of groups is reached. Finds the closest
+    pair from the lowest distance of each row of a RowMinimumMatrix */
+void ClusterFactory::mergeByRowMinimums(const VoteDiffMatrix& congressVotes,
+                                        CongressGroupVector& congressMatchGroups,
+                                        short noiseThreshold, short minGroups,
+                                        bool traceOutput, ClusterDistanceSums* distanceSums)
+{
+    RowMinimumMatrix distances(congressVotes);
+
+    unsigned short clusterCount = distances.size();
+    unsigned short cluster1, cluster2;
+    short mergeDistance;
+    while ((clusterCount > minGroups) && distances.findClosestPair(cluster1, cluster2, mergeDistance) &&
+            (mergeDistance <= noiseThreshold)) {
+        // The pair comes back in order, so the first keeps the lower number
+        mergeClusters(congressMatchGroups, cluster2, cluster1);
+        if (distanceSums)
+            distanceSums->merge(cluster1, cluster2);
+        distances.merge(cluster1, cluster2);
+        clusterCount--;
+        if (traceOutput)
+            cerr << "Merge cluster " << cluster1 << " and " << cluster2
+                 << " at distance " << mergeDistance << endl;
+    } // while clusters to merge
 }
 
 // Helper method to calculate distance data for a newly merged cluster
@@ -299,7 +371,7 @@ void ClusterFactory::debugOutputClusterList(const CongressGroupVector& congressM
     unsigned short index;
     for (index = 0; index < congressMatchGroups.size(); index++) {
         cerr << index << ": ";
-        CongressGroup::iterator temp;
+        CongressGroup::const_iterator temp;
         for (temp = congressMatchGroups.at(index).begin();
             temp != congressMatchGroups.at(index).end(); temp++) {
                 CongressData::CongressPerson data = congressData.getData(*temp);
@@ -324,23 +396,16 @@ void ClusterFactory::getClusterDistanceMap(const VoteDiffMatrix& congressVoteMap
     }
 
     // Insure previous results do not carry over
-    vector<short> tempResult(congressGroupList.size(), 0);
-    groupVotesMap.assign(congressGroupList.size(), tempResult);
+    groupVotesMap.assign(congressGroupList.size(), 0);
 
-    // If only one cluster, can quit now
-    if (congressGroupList.size() == 1)
-        return;
-
-    /* Every cluster combination appears in the matrix twice. To avoid a double
-        calculation, find the value once and insert it in both spots */
+    // The matrix stores each cluster combination once, in the lower triangle
     unsigned short index1, index2;
-    for (index1 = 0; index1 < (congressGroupList.size() - 1); index1++)
-        for (index2 = index1 + 1; index2 < congressGroupList.size(); index2++) {
-            groupVotesMap.at(index1).at(index2) = findClusterDistance(congressVoteMap,
-                                                                        congressGroupList.at(index1),
-                                                                        congressGroupList.at(index2));
-            groupVotesMap.at(index2).at(index1) = groupVotesMap.at(index1).at(index2);
-        }
+    for (index1 = 1; index1 < congressGroupList.size(); index1++) {
+        short* groupRow = groupVotesMap.getRow(index1);
+        for (index2 = 0; index2 < index1; index2++)
+            groupRow[index2] = findClusterDistance(congressVoteMap, congressGroupList[index1],
+                                                   congressGroupList[index2]);
+    }
     return;
 }
 
@@ -349,13 +414,17 @@ short ClusterFactory::findClusterDistance(const VoteDiffMatrix& congressVoteMap,
                                         const CongressGroup& cluster1,
                                         const CongressGroup& cluster2)
 {
-    CongressGroup::const_iterator index1, index2;
+    // Every member of one cluster is paired with every member of the other, so list them once
+    vector<unsigned short> members1, members2;
+    cluster1.getMembers(members1);
+    cluster2.getMembers(members2);
+    vector<unsigned short>::const_iterator index1, index2;
     int totalVoteDiff = 0; // Sum values in int to prevent overflow
     int voteCount = 0;
 
-    for (index1 = cluster1.begin(); index1 != cluster1.end(); index1++)
-        for (index2 = cluster2.begin(); index2 != cluster2.end(); index2++) {
-            totalVoteDiff += (int)congressVoteMap.at(*index1).at(*index2);
+    for (index1 = members1.begin(); index1 != members1.end(); index1++)
+        for (index2 = members2.begin(); index2 != members2.end(); index2++) {
+            totalVoteDiff += (int)congressVoteMap.get(*index1, *index2);
             voteCount++;
         }
     /* This division will have rounding error. The code assumes the number of
@@ -395,13 +464,27 @@ void ClusterFactory::getClusterCongressData(const CongressGroupVector& congressG
     }
 }
 
+/* Lists every Congressperson group by group, in the order of the group list, so
+    members who vote alike are next to each other */
+void ClusterFactory::getMemberOrder(const CongressGroupVector& congressGroupList,
+                                    vector<unsigned short>& memberOrder)
+{
+    memberOrder.clear();
+    CongressGroupVector::const_iterator groupIndex;
+    for (groupIndex = congressGroupList.begin(); groupIndex != congressGroupList.end(); groupIndex++) {
+        CongressGroup::const_iterator member;
+        for (member = groupIndex->begin(); member != groupIndex->end(); member++)
+            memberOrder.push_back(*member);
+    }
+}
+
 // Outputs the contents of the cluster data list
 void ClusterFactory::debugOutputClusterList(const CongressGroupDataList& congressGroupData)
 {
     unsigned short index;
     for (index = 0; index < congressGroupData.size(); index++) {
         cerr << index << ": ";
-        CongressGroup::iterator temp;
+        CongressGroup::const_iterator temp;
         for (temp = congressGroupData[index]._group.begin();
             temp != congressGroupData[index]._group.end(); temp++)
                 cerr << *temp << " ";
@@ -421,3 +504,152 @@ void ClusterFactory::debugOutputClusterList(const CongressGroupDataList& congres
 }
 
 
+
+/* Times both cluster methods on made up vote differences for a range of member
+    counts, doubling from the first up to the last, and checks they find the same
+    clusters. Results are written to standard error */
+void ClusterFactory::debugBenchmarkClusterMethods(unsigned short firstMemberCount,
+                                                  unsigned short lastMemberCount)
+{
+    typedef std::chrono::steady_clock Clock;
+    if (firstMemberCount < 2)
+        firstMemberCount = 2;
+    double lastChainTime = 0.0;
+    unsigned int memberCount;
+    for (memberCount = firstMemberCount; memberCount <= lastMemberCount; memberCount *= 2) {
+        VoteDiffMatrix differences;
+        makeBenchmarkDifferences(memberCount, differences);
+
+        CongressGroupVector sortedGroups, chainGroups;
+        unsigned int index1;
+        for (index1 = 0; index1 < memberCount; index1++) {
+            CongressGroup newGroup;
+            newGroup.insert(index1);
+            sortedGroups.push_back(newGroup);
+        }
+
+        /* Freeing the millions of tree nodes of the sorted distances leaves the heap
+            in a state that slows down the allocations that follow, so time the nearest
+            neighbor chain first */
+        Clock::time_point start = Clock::now();
+        Dendrogram dendrogram;
+        dendrogram.build(differences);
+        dendrogram.cut(150, 20, chainGroups);
+        double chainTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        /* Building the groups allocates the words of each group's bitmap the same way
+            with either method, so count allocations finding the merges alone */
+        NearestNeighborChain::MergeList merges;
+        unsigned long startAllocations = AllocationCounter::getCount();
+        NearestNeighborChain::findMerges(differences, LinkageMatrix::linkageComplete, merges);
+        unsigned long chainAllocations = AllocationCounter::getCount() - startAllocations;
+
+        // The other linkages only differ in the arithmetic of each distance update
+        const LinkageMatrix::Linkage otherLinkages[3] = { LinkageMatrix::linkageSingle,
+            LinkageMatrix::linkageAverage, LinkageMatrix::linkageWard };
+        double otherTimes[3];
+        unsigned short linkageIndex;
+        for (linkageIndex = 0; linkageIndex < 3; linkageIndex++) {
+            start = Clock::now();
+            NearestNeighborChain::findMerges(differences, otherLinkages[linkageIndex], merges);
+            otherTimes[linkageIndex] = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        start = Clock::now();
+        mergeBySortedDistances(differences, sortedGroups, 150, 20, false, 0);
+        removeEmptyGroups(sortedGroups);
+        double sortedTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        cerr << memberCount << " members: sorted distances " << sortedTime << " ms, nearest neighbor chain "
+             << chainTime << " ms, " << (sortedTime / chainTime) << "x faster";
+        if (lastChainTime > 0.0)
+            cerr << ", " << (chainTime / lastChainTime) << "x the time for half as many";
+        if (AllocationCounter::isEnabled())
+            cerr << ", " << chainAllocations << " allocations for " << merges.size() << " merges";
+        if (sortedGroups != chainGroups)
+            cerr << " WARNING: clusters differ";
+        cerr << endl << "    merges only, single linkage " << otherTimes[0] << " ms, average "
+             << otherTimes[1] << " ms, Ward " << otherTimes[2] << " ms" << endl;
+        lastChainTime = chainTime;
+    } // For each member count
+}
+
+/* Times row minimums against sorted distances and the nearest neighbor chain on
+    made up vote differences for a House, 5000 members and 20000 members, and
+    checks they find the same clusters. Results are written to standard error */
+void ClusterFactory::debugBenchmarkRowMinimums(unsigned int sortedMemoryLimitMb)
+{
+    typedef std::chrono::steady_clock Clock;
+    RowMinimumMatrix::debugBenchmark();
+
+    /* Each pair of clusters costs sorted distances a tree node of about 40 bytes and
+        an iterator to it. Skip it where that passes the limit */
+    const double sortedBytesPerPair = 48.0;
+    const unsigned int memberCounts[3] = { 435, 5000, 20000 };
+    unsigned short countIndex;
+    for (countIndex = 0; countIndex < 3; countIndex++) {
+        unsigned int memberCount = memberCounts[countIndex];
+        VoteDiffMatrix differences;
+        makeBenchmarkDifferences(memberCount, differences);
+
+        CongressGroupVector rowGroups, chainGroups, sortedGroups;
+        unsigned int index;
+        for (index = 0; index < memberCount; index++) {
+            CongressGroup newGroup;
+            newGroup.insert(index);
+            rowGroups.push_back(newGroup);
+        }
+        sortedGroups = rowGroups;
+
+        Clock::time_point start = Clock::now();
+        mergeByRowMinimums(differences, rowGroups, 150, 20, false, 0);
+        removeEmptyGroups(rowGroups);
+        double rowTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        start = Clock::now();
+        Dendrogram dendrogram;
+        dendrogram.build(differences);
+        dendrogram.cut(150, 20, chainGroups);
+        double chainTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        cerr << memberCount << " members: row minimums " << rowTime << " ms, nearest neighbor chain "
+             << chainTime << " ms";
+        if (rowGroups != chainGroups)
+            cerr << " WARNING: clusters differ";
+        double sortedMb = (sortedBytesPerPair * memberCount * (memberCount - 1) / 2) / (1024.0 * 1024.0);
+        if (sortedMb > sortedMemoryLimitMb)
+            cerr << ", sorted distances skipped, needs about " << (unsigned long)sortedMb << " MB";
+        else {
+            start = Clock::now();
+            mergeBySortedDistances(differences, sortedGroups, 150, 20, false, 0);
+            removeEmptyGroups(sortedGroups);
+            double sortedTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            cerr << ", sorted distances " << sortedTime << " ms, " << (sortedTime / rowTime)
+                 << "x slower than row minimums";
+            if (rowGroups != sortedGroups)
+                cerr << " WARNING: clusters differ";
+        }
+        cerr << endl;
+    } // For each member count
+}
+
+/* Makes up vote differences shaped like a House session: two parties far apart,
+    members spread out within each, and some noise on every pair. Scrambling the
+    indexes by multiplying with a large odd number does this without depending on
+    a random number generator */
+void ClusterFactory::makeBenchmarkDifferences(unsigned int memberCount, VoteDiffMatrix& differences)
+{
+    vector<short> positions(memberCount);
+    unsigned int index1, index2;
+    for (index1 = 0; index1 < memberCount; index1++)
+        positions[index1] = (short)((index1 % 2) * 600 + ((index1 * 2654435761u) >> 16) % 300);
+    differences.assign(memberCount);
+    for (index1 = 1; index1 < memberCount; index1++) {
+        short* row = differences.getRow(index1);
+        for (index2 = 0; index2 < index1; index2++) {
+            int difference = std::abs(positions[index1] - positions[index2]) +
+                (int)((((index1 * 40503u) ^ (index2 * 2654435761u)) >> 12) % 100);
+            row[index2] = (short)std::min(difference, 1000);
+        }
+    }
+}
@@ -40,19 +40,25 @@
         is the best method available for doing that.
     */
 
-#include<map>
 #include<set>
 
-using std::multimap;
 using std::set;
 
+/* NOTE: The linkage is part of the interface for forming clusters, so every user
+    needs this header anyway. The same goes for the groups they return */
+#include"linkageMatrix.h"
+#include"congressGroup.h"
+
+// Only used by pointer, so callers that don't need them don't need the headers
+class Dendrogram;
+class ClusterDistanceSums;
+
 /* NOTE: The following are defined in headers deliberately not included,
     because they are widely used and the source should include the headers anyway */
 using std::swap;
 using std::pair;
 using std::vector;
 
-typedef set<unsigned short> CongressGroup;
 typedef vector<CongressGroup> CongressGroupVector;
 
 struct CongressGroupData
@@ -88,11 +94,15 @@ class GroupDistanceMap
         value update is needed for any pair of clusters.
 
         For the purpose of finding the lowest distance, it keeps a sorted list
-        of cluster pairs indexed by distance, using a multi-map. Multimaps have
-        the nice property that iterators are stable unless the entry itself is
-        changed, so storing the iterators in the ragged array allows direct access
-        to the entry in the sorted distances multimap. This way, distance data
-        can be directly looked up without storing it twice.
+        of cluster pairs indexed by distance, using a set. Sets have the nice
+        property that iterators are stable unless the entry itself is changed,
+        so storing the iterators in the ragged array allows direct access to the
+        entry in the sorted distances set. This way, distance data can be directly
+        looked up without storing it twice. Each entry holds the distance and then
+        the cluster pair, so pairs at the same distance are sorted by cluster
+        number. Which pair is merged first when distances tie can change the final
+        clusters, so this makes them depend only on the distances, and not on the
+        order they were last updated. NearestNeighborChain breaks ties the same way.
 
         Efficiency overview: Every merge will require updating N distance
         entries, to account for the newly formed cluster relative to the remainder.
@@ -102,8 +112,8 @@ class GroupDistanceMap
         of the number of entries. The size of the sorted list is N^2, so the cost of a
         merge is 2logN. Combine this to get a final cost of O(NlogN), an amazing coincidence.
 
-        The first item in the multi-map is the next pair to merge, so finding the next
-        pair to merge is constant time. The alternative is to search the multi-map
+        The first item in the set is the next pair to merge, so finding the next
+        pair to merge is constant time. The alternative is to search the set
         every time. Updates are done in constant time, but every search is now O(N^2),
         because the ragged array is not sorted and must be linearly searched. Finally,
         if the merging process is reported until there is only one group left, N-1
@@ -151,7 +161,7 @@ private:
     GroupDistanceMap(const GroupDistanceMap& other);
     GroupDistanceMap operator=(const GroupDistanceMap& other);
 
-    typedef multimap<short, ClusterPair> DistanceMap;
+    typedef set<pair<short, ClusterPair> > DistanceMap;
     typedef DistanceMap::iterator DistancePtr;
 
     DistanceMap _sortedDistances;
@@ -251,16 +261,42 @@ class ClusterFactory
 public:
     static short meaningfulDifferenceLimit;
 
+    /* How the clusters are found. Sorted distances keeps every distance between
+        clusters in a GroupDistanceMap, and merges the closest pair each time. Nearest
+        neighbor chain finds the same merges in O(N^2) time on a copy of the distance
+        matrix; see NearestNeighborChain. Both break ties between equal distances the
+        same way, so the clusters are identical. Sorted distances remains for its trace
+        output, which shows every distance after each merge, but only supports complete
+        linkage. Row minimums also merges the closest pair each time, found from the
+        lowest distance of each row of a plain matrix; see RowMinimumMatrix. It too
+        finds the same clusters, and only supports complete linkage. Other linkages
+        always use the nearest neighbor chain */
+    enum ClusterMethod { clusterSortedDistances, clusterNearestNeighborChain, clusterRowMinimums };
+
     /* Given the map of vote differences indexed by congresspersons and the level
         of vote differences considered to be noise, returns the groups of congressmen.
-        The last optional parameter is a lower limit on the number of groups, used to
+        The minimum group count is a lower limit on the number of groups, used to
         prevent returning a few huge blobs if the noise threshold is chosen badly.
-        Internally, the method implements the classic complete linkage grouping algorithm */
+        Internally, the method implements the classic complete linkage grouping algorithm,
+        or another linkage if given; see LinkageMatrix for what each does. Under linkages
+        other than complete, members of a group can differ by more than the threshold.
+        If a dendrogram is given, every merge is recorded in it, so groups for other
+        thresholds can be cut from it without clustering again. Recording always uses
+        the nearest neighbor chain. If a group difference matrix is given, it receives
+        the same results as getClusterDistanceMap() for the groups returned. They are
+        kept up to date as clusters merge, which is far faster than finding them after */
     static void formClusters(const VoteDiffMatrix& congressVotes,
                             CongressGroupVector& congressMatchGroups,
                             const CongressData& congressData, // Needed for trace
                             short noiseThreshold = 100, short minGroups = 0,
-                            bool traceOutput = false);
+                            bool traceOutput = false,
+                            ClusterMethod method = clusterNearestNeighborChain,
+                            LinkageMatrix::Linkage linkage = LinkageMatrix::linkageComplete,
+                            Dendrogram* dendrogram = 0, VoteDiffMatrix* groupVotesMap = 0);
+
+    /* Removes the groups emptied by merging their members into others. The groups
+        left keep the order formClusters() has always returned them in */
+    static void removeEmptyGroups(CongressGroupVector& congressMatchGroups);
 
     /* Finds the average vote difference between every pair of clusters. The
         difference map is indexed by the order clusters appear in the supplied
@@ -277,6 +313,12 @@ public:
                                        const RegionMapper& regions,
                                        CongressGroupDataList& congressGroupData);
 
+    /* Lists every Congressperson group by group, in the order of the group list, so
+        members who vote alike are next to each other. Exporting the vote differences
+        in this order compresses them far better; see MatrixExport */
+    static void getMemberOrder(const CongressGroupVector& congressGroupList,
+                               vector<unsigned short>& memberOrder);
+
     // Outputs the contents of the cluster list, with identification informmation
     static void debugOutputClusterList(const CongressGroupVector& congressMatchGroups,
                                        const CongressData& congressData);
@@ -284,7 +326,38 @@ public:
     // Outputs the contents of the cluster data list
     static void debugOutputClusterList(const CongressGroupDataList& congressGroupData);
 
+    /* Times both cluster methods on made up vote differences for a range of member
+        counts, doubling from the first up to the last, and checks they find the same
+        clusters. Results are written to standard error */
+    static void debugBenchmarkClusterMethods(unsigned short firstMemberCount = 250,
+                                             unsigned short lastMemberCount = 4000);
+
+    /* Times row minimums against sorted distances and the nearest neighbor chain on
+        made up vote differences for a House, 5000 members and 20000 members, and
+        checks they find the same clusters. Sorted distances is skipped for member
+        counts where its tree of distances would take more than the given memory.
+        Results are written to standard error */
+    static void debugBenchmarkRowMinimums(unsigned int sortedMemoryLimitMb = 2048);
+
 private:
+    /* Merge clusters for formClusters() until the closest pair is further apart than
+        the noise threshold, or the minimum number of groups is reached */
+    static void mergeBySortedDistances(const VoteDiffMatrix& congressVotes,
+                                       CongressGroupVector& congressMatchGroups,
+                                       short noiseThreshold, short minGroups,
+                                       bool traceOutput, ClusterDistanceSums* distanceSums);
+
+    /* Merge clusters for formClusters() the same way, finding the closest pair from
+        the lowest distance of each row */
+    static void mergeByRowMinimums(const VoteDiffMatrix& congressVotes,
+                                   CongressGroupVector& congressMatchGroups,
+                                   short noiseThreshold, short minGroups,
+                                   bool traceOutput, ClusterDistanceSums* distanceSums);
+
+    /* Makes up vote differences shaped like a House session, without depending on
+        a random number generator, for the benchmarks */
+    static void makeBenchmarkDifferences(unsigned int memberCount, VoteDiffMatrix& differences);
+
     // Finds the distances between a newly merged cluster and all other clusters
     static void mergeClusters(CongressGroupVector& groups, unsigned short source,
                               unsigned short destination);
@@ -320,8 +393,7 @@ inline unsigned short ClusterFactory::findMergeClusterIndex(unsigned short clust
 inline void ClusterFactory::mergeClusters(CongressGroupVector& groups, unsigned short source,
                                             unsigned short destination)
 {
-    groups.at(destination).insert(groups.at(source).begin(),
-                                  groups.at(source).end());
+    groups.at(destination).unite(groups.at(source));
     groups.at(source).clear();
 }
 
@@ -28,7 +28,8 @@
 #include<cctype>
 #include<utility>
 #include<vector>
-#include<cstdlib>
+#include<set>
+#include<chrono>
 #include"congressData.h"
 
 /* This objerct reads roll call results from XML files, one per roll call.
@@ -43,6 +44,7 @@ using std::string;
 using std::stringstream;
 using std::istringstream;
 using std::map;
+using std::set;
 using std::vector;
 using std::endl;
 using std::cerr;
@@ -59,6 +61,68 @@ const string CongressData::_stateKey = " state="; // Note the leading space
 // Constructor. Throws ios_base::failure if initialization fails
 CongressData::CongressData(short sessionStartYear, bool parseTrace)
 {
+    _firstRefNo = 0;
+    CongressPersonsBySession sessions;
+    parseSessions(sessionStartYear, sessionStartYear, sessions, parseTrace);
+    _congressData.swap(sessions[sessionStartYear]);
+
+    /* Check for the correct number of Congressmen. This is harder than it sounds. People can
+        resign, die, or otherwise get replaced during the term, in which case two names
+        appear for the same district, with different IDs. The parser is more likely to skip
+        data rather than generate extra, so an estimate of an upper limit should be good enough */
+    if (!checkSessionSize(sessionStartYear, _congressData)) {
+        stringstream errorText;
+        errorText << "people.xml parse fail, expected between 435 and 460 values, found " << _congressData.size();
+        _congressData.clear();
+        throw ios_base::failure(errorText.str());
+    }
+
+    /* Since indexes start from zero, the position in the vector gives the index value.
+        The parse already rejected duplicate reference IDs */
+    unsigned short index;
+    for (index = 0; index < _congressData.size(); index++)
+        _refIndexMap.insert(std::make_pair(_congressData[index]._refNo, index));
+
+    // Add an extra blank data, used to handle errors
+    CongressPerson temp;
+    temp._refNo = 0;
+    _congressData.push_back(temp);
+    buildRefIndexTable();
+}
+
+// Parser only object, used by readSessions()
+CongressData::CongressData()
+{
+    _firstRefNo = 0;
+}
+
+/* Reads the Congresspeople of every session starting between the two years with
+    one pass through people.xml, which holds every session. Sessions with an
+    implausible number of members are reported and left out. Throws
+    ios_base::failure if the file can't be read */
+void CongressData::readSessions(short firstSessionYear, short lastSessionYear,
+                                CongressPersonsBySession& sessions, bool parseTrace)
+{
+    sessions.clear();
+    CongressData parser;
+    parser.parseSessions(firstSessionYear, lastSessionYear, sessions, parseTrace);
+
+    CongressPersonsBySession::iterator session = sessions.begin();
+    while (session != sessions.end())
+        if (!checkSessionSize(session->first, session->second))
+            session = sessions.erase(session);
+        else
+            session++;
+}
+
+/* Reads people.xml once, adding every Representative of the sessions starting
+    between the two years to the results. Throws ios_base::failure if the file
+    is missing or malformed */
+void CongressData::parseSessions(short firstSessionYear, short lastSessionYear,
+                                 CongressPersonsBySession& sessions, bool parseTrace)
+{
+    // Reference IDs already found in each session, to catch duplicates
+    map<short, set<int> > sessionRefNos;
     try {
         if (parseTrace)
             setTrace();
@@ -88,9 +152,10 @@ CongressData::CongressData(short sessionStartYear, bool parseTrace)
             }
 
             CongressPerson newData;
+            newData._refNo = refNo;
             newData._name = getTextForKey(_nameKey);
-            string roleType(getTextForKey(_roleKey));
-            string startDate(getTextForKey(_startDateKey));
+            string_view roleType(getTextForKey(_roleKey));
+            string_view startDate(getTextForKey(_startDateKey));
             newData._party = getTextForKey(_partyKey, false);
             newData._state = getTextForKey(_stateKey, false);
 
@@ -100,60 +165,79 @@ CongressData::CongressData(short sessionStartYear, bool parseTrace)
                 then takes over a Senate term, the input title uses their later title for
                 the house term data */
             if (roleType == "rep") {
-                /* Need to filter for the wanted Congressional session. For representatives, this
+                /* Need to filter for the wanted Congressional sessions. For representatives, this
                     is easy, since they are elected every session. Extract the year from the
-                    start date and compare it to the wanted session year. The year is first in
+                    start date and find the session starting that year. The year is first in
                     the date format, and always has four digits
                     TRICKY NOTE: A Representative can start in the middle of the session thanks
-                    to death, resignations, etc. Allow a start date one year later as well
-                    SEMI-HACK: This is not the 'official' way of extracting a numeric from a
-                    string, but it is the fastest */
-                short year = atoi(string(startDate,0, 4).c_str());
-
-                if ((year == sessionStartYear) ||
-                    (year == (sessionStartYear + 1))) {
-                    /* Insert the new reference ID in the map to internal indexes. Since indexes
-                        start from zero, the current size of the vector gives the index value.
-                        A failed insert indicates a duplicate reference ID, which is a huge
+                    to death, resignations, etc. A start date one year later belongs to the
+                    same session */
+                int year;
+                if (!textToNumber(startDate.substr(0, 4), year))
+                    year = 0; // Matches no session
+                int sessionYear = year - ((year - firstSessionYear) & 1);
+
+                if ((year != 0) && (sessionYear >= firstSessionYear) &&
+                    (sessionYear <= lastSessionYear)) {
+                    /* A failed insert indicates a duplicate reference ID, which is a huge
                         data error */
-                    if (!_refIndexMap.insert(std::make_pair(refNo,
-                                                            (unsigned short)_congressData.size())).second) {
+                    if (!sessionRefNos[sessionYear].insert(refNo).second) {
                         stringstream errorText;
                         errorText << "people.xml parse fail, person id key value " << refNo << " duplicated";
                         cerr << errorText.str() << endl;
                         throw ios_base::failure(errorText.str());
-                    } // Map insert failed
-                    _congressData.push_back(newData);
+                    } // Set insert failed
+                    sessions[sessionYear].push_back(newData);
                 } // Year matches wanted session
             } // Role is Representative
             // Find next set of keys
             burnToKey(_refIdKey);
         } // Text to search
-
-        /* Check for the correct number of Congressmen. This is harder than it sounds. People can
-            resign, die, or otherwise get replaced during the term, in which case two names
-            appear for the same district, with different IDs. The parser is more likely to skip
-            data rather than generate extra, so an estimate of an upper limit should be good enough */
-        if ((_congressData.size() < 435) || (_congressData.size() > 460)) {
-            stringstream errorText;
-            errorText << "people.xml parse fail, expected between 435 and 460 values, found " << _congressData.size();
-            cerr << errorText.str() << endl;
-            throw ios_base::failure(errorText.str());
-        }
-
-        // Add an extra blank data, used to handle errors
-        CongressPerson temp;
-        _congressData.push_back(temp);
     }
     catch (...) {
         // Ensure memory does not leak
-        _refIndexMap.clear();
-        _congressData.clear();
-        /* NOTE: Superclass constructor will be called, so don't need
+        sessions.clear();
+        /* NOTE: Superclass destructor will be called, so don't need
             to clean up the actual file */
         throw;
     }
+}
+
+/* Returns true if the number of Congresspeople found is plausible for a session.
+    The error for a bad count is written to standard error */
+bool CongressData::checkSessionSize(short sessionStartYear, const CongressPersonList& congressData)
+{
+    // See the constructor for why the limits are so loose
+    if ((congressData.size() >= 435) && (congressData.size() <= 460))
+        return true;
+    cerr << "people.xml parse fail, expected between 435 and 460 values for the session starting "
+         << sessionStartYear << ", found " << congressData.size() << endl;
+    return false;
+}
+
+/* Load data about congresspersons from a list saved earlier, without reading any
+    files. Throws ios_base::failure if the list is not valid for a session */
+CongressData::CongressData(const CongressPersonList& congressData) : _congressData(congressData)
+{
+    _firstRefNo = 0;
+    // The list came from an earlier parse, so only the reference IDs need checking
+    unsigned short index;
+    for (index = 0; index < _congressData.size(); index++)
+        if (!_refIndexMap.insert(std::make_pair(_congressData[index]._refNo, index)).second) {
+            stringstream errorText;
+            errorText << "Saved congressperson data invalid, person id " << _congressData[index]._refNo
+                      << " duplicated";
+            cerr << errorText.str() << endl;
+            _refIndexMap.clear();
+            _congressData.clear();
+            throw ios_base::failure(errorText.str());
+        }
 
+    // Add an extra blank data, used to handle errors
+    CongressPerson temp;
+    temp._refNo = 0;
+    _congressData.push_back(temp);
+    buildRefIndexTable();
 }
 
 CongressData::~CongressData()
@@ -161,10 +245,78 @@ CongressData::~CongressData()
     // Do nothing; subclass destructor does everything
 }
 
+// Builds the lookup table from the map
+void CongressData::buildRefIndexTable(void)
+{
+    /* The largest span of ref_ids worth a table. Current members span a few
+        thousand; this allows far more while keeping the table small compared
+        to the vote data */
+    const unsigned int maxTableSize = 65536;
+
+    _refIndexTable.clear();
+    if (_refIndexMap.empty())
+        return;
+    // The map is sorted, so the ends give the span
+    _firstRefNo = _refIndexMap.begin()->first;
+    unsigned int tableSize = (unsigned int)(_refIndexMap.rbegin()->first - _firstRefNo) + 1;
+    if (tableSize > maxTableSize)
+        return; // Use the map instead
+
+    _refIndexTable.assign(tableSize, SHRT_MAX);
+    map<int, unsigned short>::const_iterator index;
+    for (index = _refIndexMap.begin(); index != _refIndexMap.end(); index++)
+        _refIndexTable[index->first - _firstRefNo] = index->second;
+}
+
+/* Times ref_id lookups through the table against the map it replaced, using
+    every Congressperson in the session. Results are written to standard error */
+void CongressData::debugBenchmarkIndex(unsigned int iterations) const
+{
+    /* Roll call files list voters in order by state, not ref_id, so look them
+        up in a scrambled order. Stepping through the list by a prime larger
+        than it does this without depending on a random number generator */
+    vector<int> refNos;
+    unsigned short memberCount = getSize();
+    unsigned short index;
+    for (index = 0; index < memberCount; index++)
+        refNos.push_back(_congressData[(index * 503) % memberCount]._refNo);
+    if (refNos.empty())
+        return;
+
+    typedef std::chrono::steady_clock Clock;
+    unsigned long lookupCount = (unsigned long)iterations * refNos.size();
+
+    // Sum the results so the compiler can't discard the lookups, and to compare them
+    unsigned long mapTotal = 0;
+    Clock::time_point start = Clock::now();
+    unsigned int pass;
+    for (pass = 0; pass < iterations; pass++)
+        for (index = 0; index < refNos.size(); index++) {
+            map<int, unsigned short>::const_iterator found = _refIndexMap.find(refNos[index]);
+            mapTotal += (found != _refIndexMap.end()) ? found->second : SHRT_MAX;
+        }
+    double mapTime = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    cerr << "map lookup: " << (mapTime / lookupCount) << " ns per lookup" << endl;
+
+    unsigned long tableTotal = 0;
+    start = Clock::now();
+    for (pass = 0; pass < iterations; pass++)
+        for (index = 0; index < refNos.size(); index++)
+            tableTotal += getIndexNo(refNos[index]);
+    double tableTime = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    cerr << "table lookup: " << (tableTime / lookupCount) << " ns per lookup, "
+         << (mapTime / tableTime) << "x map speed, table size " << _refIndexTable.size();
+    if (_refIndexTable.empty())
+        cerr << " (span too large, map used)";
+    if (tableTotal != mapTotal)
+        cerr << " WARNING: results differ from map";
+    cerr << endl;
+}
+
 /* Extracts the text value for a given key. Throws ios_base::failure
     if not found. The flag indicates whether the key field must appear on the
     current line to be valid */
-string CongressData::getTextForKey(const string& key, bool wrapLine)
+string_view CongressData::getTextForKey(const string& key, bool wrapLine)
 {
     // Find first key, not finding it indicates an inconsistency
     burnToKey(key, wrapLine);
@@ -175,7 +327,7 @@ string CongressData::getTextForKey(const string& key, bool wrapLine)
         throw ios_base::failure(errorText.str());
     }
     burnChars(1); // Eliminate the '"'
-    string result(getTextToToken('"'));
+    string_view result(getTextViewToToken('"'));
 
     // The end token must exist, so reaching the end of the line indicates an error
     if (haveLineEnd()) {
@@ -48,15 +48,26 @@ using std::vector;
    here is to collapse the map of all data into an array with an internal index. The actual
    map then holds only the internal index, reducing memory usage significantly. Indexing
    arrays by congressperson is used elsewhere in this project, so the ref_id translation
-   needs to be public */
+   needs to be public.
+
+   The translation happens for every vote in every roll call file, so a map lookup
+   there is too slow. Once the file is read, the ref_ids for the session are known, and
+   they span a few thousand values at most (members of one session were first elected
+   within a few decades of each other). The map is then copied into a table indexed by
+   ref_id minus the smallest one, which turns the lookup into one array read. If the
+   span is ever too large for that to be sensible, the map is used directly */
 class CongressData : public XmlParser {
 public:
     struct CongressPerson {
+        int _refNo; // ref_id from the XML data
         string _name;
         string _party;
         string _state;
         // Use default constructor and destructor
     };
+    typedef vector<CongressPerson> CongressPersonList;
+    // Congresspeople of several sessions, indexed by the session start year
+    typedef map<short, CongressPersonList> CongressPersonsBySession;
 
 private:
   // XNL tage with wanted data
@@ -68,12 +79,34 @@ private:
   static const string _stateKey;
 
   map<int, unsigned short> _refIndexMap;
-  vector<CongressPerson> _congressData;
+  CongressPersonList _congressData;
+
+  // Copy of the map as a table, for fast lookups. Empty if the ref_ids are too spread out
+  vector<unsigned short> _refIndexTable;
+  int _firstRefNo; // ref_id of the first table entry
+
+  // Builds the lookup table from the map
+  void buildRefIndexTable(void);
+
+  /* Reads people.xml once, adding every Representative of the sessions starting
+    between the two years to the results. Sessions start every two years, so the
+    last year should be a multiple of two after the first. Throws ios_base::failure
+    if the file is missing or malformed */
+  void parseSessions(short firstSessionYear, short lastSessionYear,
+                     CongressPersonsBySession& sessions, bool parseTrace);
+
+  /* Returns true if the number of Congresspeople found is plausible for a session.
+    The error for a bad count is written to standard error */
+  static bool checkSessionSize(short sessionStartYear, const CongressPersonList& congressData);
+
+  // Parser only object, used by readSessions()
+  CongressData();
 
   /* Extracts the text value for a given key. Throws ios_base::failure
     if not found. The flag indicates whether the key field must appear on the
-    current line to be valid */
-  string getTextForKey(const string& key, bool wrapLine = true);
+    current line to be valid. The result is a view into the file, so copy
+    anything that must outlast the parse */
+  string_view getTextForKey(const string& key, bool wrapLine = true);
 
   /* Assignment operator and copy constructor. The parser can't be copied
      (this requires the ability to open the same file twice, which is
@@ -86,19 +119,35 @@ public:
         Second flag logs the file input during parsing */
     CongressData(short sessionStartYear, bool parseTrace=false);
 
+    /* Load data about congresspersons from a list saved earlier, without reading any
+        files. Throws ios_base::failure if the list is not valid for a session */
+    explicit CongressData(const CongressPersonList& congressData);
+
     ~CongressData();
 
+    /* Reads the Congresspeople of every session starting between the two years with
+        one pass through people.xml, which holds every session. Sessions with an
+        implausible number of members are reported and left out. Throws
+        ios_base::failure if the file can't be read. Create the object for each
+        session from its list */
+    static void readSessions(short firstSessionYear, short lastSessionYear,
+                             CongressPersonsBySession& sessions, bool parseTrace = false);
+
 	/* Gets the data on a representative given their array index.
         Note that this is not the RefNo from the vote data (see below for that) */
     const CongressPerson& getData(unsigned short indexNo) const;
 
     /* Given the refNo from the XML data, gets the array index. Internally this
-        is a lookup on a map. A missing congressman returns MAXSHORT */
+        is a table lookup. A missing congressman returns MAXSHORT */
     int getIndexNo(int refNo) const;
 
 	/* Returns the number of congressmen in the system. Thanks to midterm changes
         (resignations, death, etc) the number may not equal 435. */
     unsigned short getSize() const;
+
+    /* Times ref_id lookups through the table against the map it replaced, using
+        every Congressperson in the session. Results are written to standard error */
+    void debugBenchmarkIndex(unsigned int iterations = 10000) const;
 };
 
 /* Gets the data on a representative given their array index.
@@ -112,9 +161,19 @@ inline const CongressData::CongressPerson& CongressData::getData(unsigned short
 }
 
 /* Given the refNo from the XML data, gets the array index. Internally this
-    is a lookup on a map. A missing congressman returns MAXSHORT; */
+    is a table lookup. A missing congressman returns MAXSHORT; */
 inline int CongressData::getIndexNo(int refNo) const
 {
+    if (!_refIndexTable.empty()) {
+        /* Unsigned math makes a refNo below the first one wrap around to a huge
+            offset, so one test catches values off either end of the table */
+        unsigned int offset = (unsigned int)refNo - (unsigned int)_firstRefNo;
+        if (offset < _refIndexTable.size())
+            return _refIndexTable[offset];
+        else
+            return SHRT_MAX;
+    }
+
     // Yes, its a clunky definition, but this is the only iterator in the class
     map<int, unsigned short>::const_iterator index = _refIndexMap.find(refNo);
     if (index != _refIndexMap.end())
@@ -0,0 +1,82 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+// The members of a group of Congresspeople, as a bitmap
+#include<vector>
+#include<bitset>
+#include<algorithm>
+#include"congressGroup.h"
+
+using std::vector;
+using std::bitset;
+
+// Adds one member. Does nothing if they are already in the group
+void CongressGroup::insert(unsigned short member)
+{
+    size_t wordIndex = member / bitsPerWord;
+    if (wordIndex >= _words.size())
+        _words.resize(wordIndex + 1, 0);
+    Word bit = (Word)1 << (member % bitsPerWord);
+    if (!(_words[wordIndex] & bit)) {
+        _words[wordIndex] |= bit;
+        _count++;
+    }
+}
+
+// Adds every member of another group to this one
+void CongressGroup::unite(const CongressGroup& other)
+{
+    if (other._words.size() > _words.size())
+        _words.resize(other._words.size(), 0);
+    // The groups may share members, so count the result again
+    unsigned int count = 0;
+    size_t wordIndex;
+    for (wordIndex = 0; wordIndex < other._words.size(); wordIndex++) {
+        _words[wordIndex] |= other._words[wordIndex];
+        count += bitset<bitsPerWord>(_words[wordIndex]).count();
+    }
+    for (; wordIndex < _words.size(); wordIndex++)
+        count += bitset<bitsPerWord>(_words[wordIndex]).count();
+    _count = count;
+}
+
+// Lists the members in order
+void CongressGroup::getMembers(vector<unsigned short>& members) const
+{
+    members.clear();
+    members.reserve(_count);
+    const_iterator member;
+    for (member = begin(); member != end(); member++)
+        members.push_back(*member);
+}
+
+// Groups are equal if they have the same members, however many words each holds
+bool CongressGroup::operator==(const CongressGroup& other) const
+{
+    if (_count != other._count)
+        return false;
+    size_t commonWords = std::min(_words.size(), other._words.size());
+    if (!std::equal(_words.begin(), _words.begin() + commonWords, other._words.begin()))
+        return false;
+    // With the same count and the same common words, any extra words must be empty
+    return true;
+}
@@ -0,0 +1,238 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class holds the members of one group of Congresspeople as a bitmap,
+    one bit per Congressperson, packed 64 to a word. Clustering spends much of
+    its time joining groups, copying them and walking their members. A set
+    does each of these a node at a time; the bitmap joins two groups with a
+    word by word OR, tests a member with one shift and mask, and copies as a
+    single block. Walking the members finds each set bit in turn, so they come
+    out in order, the same as the set they replace.
+
+    A group only holds words up to its highest member, so a group of one early
+    member stays small even in large sessions. The member count is kept with
+    the bits, so asking for it does not count them again */
+#ifndef CONGRESS_GROUP_H_INCLUDED
+#define CONGRESS_GROUP_H_INCLUDED
+
+#include<vector>
+#include<cstdint>
+#include<cstddef>
+#include<iterator>
+#include<utility>
+
+using std::vector;
+
+class CongressGroup
+{
+public:
+    typedef uint64_t Word;
+    static const unsigned int bitsPerWord = 64;
+
+    /* Walks the members in order. Members are found from the bits, so the
+        iterator returns them by value */
+    class const_iterator
+    {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef unsigned short value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const unsigned short* pointer;
+        typedef unsigned short reference;
+
+        const_iterator();
+        unsigned short operator*(void) const;
+        const_iterator& operator++(void);
+        const_iterator operator++(int);
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const;
+
+    private:
+        friend class CongressGroup;
+        const_iterator(const Word* words, size_t wordCount, size_t wordIndex);
+
+        // Moves to the next word with bits left, if the current one has none
+        void skipEmptyWords(void);
+
+        const Word* _words;
+        size_t _wordCount;
+        size_t _wordIndex;
+        Word _remaining; // Bits of the current word not yet returned
+    };
+    typedef const_iterator iterator;
+
+    CongressGroup();
+
+    // Adds one member. Does nothing if they are already in the group
+    void insert(unsigned short member);
+
+    // Returns true if the member is in the group
+    bool contains(unsigned short member) const;
+
+    // Adds every member of another group to this one
+    void unite(const CongressGroup& other);
+
+    void clear(void);
+    void swap(CongressGroup& other);
+    bool empty(void) const;
+    unsigned short size(void) const;
+
+    // The lowest member, which names the cluster the group came from. The group must not be empty
+    unsigned short getFirst(void) const;
+
+    const_iterator begin(void) const;
+    const_iterator end(void) const;
+
+    /* Lists the members in order. Code that visits the members many times, such
+        as comparing every pair across two groups, should walk the list instead of
+        finding the bits again each time */
+    void getMembers(vector<unsigned short>& members) const;
+
+    // Groups are equal if they have the same members, however many words each holds
+    bool operator==(const CongressGroup& other) const;
+    bool operator!=(const CongressGroup& other) const;
+
+private:
+    vector<Word> _words;
+    unsigned short _count;
+
+    // Index of the lowest set bit of a word. The word must not be zero
+    static unsigned int lowestBit(Word word);
+};
+
+inline unsigned int CongressGroup::lowestBit(Word word)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    unsigned int index = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+inline CongressGroup::const_iterator::const_iterator()
+    : _words(0), _wordCount(0), _wordIndex(0), _remaining(0)
+{
+}
+
+inline CongressGroup::const_iterator::const_iterator(const Word* words, size_t wordCount, size_t wordIndex)
+    : _words(words), _wordCount(wordCount), _wordIndex(wordIndex), _remaining(0)
+{
+    if (_wordIndex < _wordCount) {
+        _remaining = _words[_wordIndex];
+        skipEmptyWords();
+    }
+}
+
+inline void CongressGroup::const_iterator::skipEmptyWords(void)
+{
+    while ((_remaining == 0) && (++_wordIndex < _wordCount))
+        _remaining = _words[_wordIndex];
+}
+
+inline unsigned short CongressGroup::const_iterator::operator*(void) const
+{
+    return (unsigned short)((_wordIndex * bitsPerWord) + lowestBit(_remaining));
+}
+
+inline CongressGroup::const_iterator& CongressGroup::const_iterator::operator++(void)
+{
+    _remaining &= _remaining - 1; // Clears the lowest set bit
+    skipEmptyWords();
+    return *this;
+}
+
+inline CongressGroup::const_iterator CongressGroup::const_iterator::operator++(int)
+{
+    const_iterator result(*this);
+    ++(*this);
+    return result;
+}
+
+// Every iterator that has run off the end of the group is the same
+inline bool CongressGroup::const_iterator::operator==(const const_iterator& other) const
+{
+    return (_wordIndex == other._wordIndex) && (_remaining == other._remaining);
+}
+
+inline bool CongressGroup::const_iterator::operator!=(const const_iterator& other) const
+{
+    return !(*this == other);
+}
+
+inline CongressGroup::CongressGroup() : _words(), _count(0)
+{
+}
+
+inline bool CongressGroup::contains(unsigned short member) const
+{
+    size_t wordIndex = member / bitsPerWord;
+    return (wordIndex < _words.size()) && ((_words[wordIndex] >> (member % bitsPerWord)) & 1);
+}
+
+inline void CongressGroup::clear(void)
+{
+    _words.clear();
+    _count = 0;
+}
+
+inline void CongressGroup::swap(CongressGroup& other)
+{
+    _words.swap(other._words);
+    std::swap(_count, other._count);
+}
+
+inline bool CongressGroup::empty(void) const
+{
+    return _count == 0;
+}
+
+inline unsigned short CongressGroup::size(void) const
+{
+    return _count;
+}
+
+inline CongressGroup::const_iterator CongressGroup::begin(void) const
+{
+    return const_iterator(_words.data(), _words.size(), 0);
+}
+
+inline CongressGroup::const_iterator CongressGroup::end(void) const
+{
+    return const_iterator(_words.data(), _words.size(), _words.size());
+}
+
+inline unsigned short CongressGroup::getFirst(void) const
+{
+    return *begin();
+}
+
+inline bool CongressGroup::operator!=(const CongressGroup& other) const
+{
+    return !(*this == other);
+}
+
+#endif // CONGRESS_GROUP_H_INCLUDED
@@ -88,7 +88,7 @@ void CorrolationFactory::getCorrolation(const CongressGroupDataList& congress, c
     for (unsigned short index = 0; index < corrolation.size(); index++)
         voteCount[index].assign(index + 1, 0);
 
-    // The vote list is a ragged array
+    // The vote list only holds the lower triangle
     unsigned short index1, index2, index3, index4;
     for (index1 = 1; index1 < votes.size(); index1++)
         for (index2 = 0; index2 < index1; index2++)
@@ -117,7 +117,7 @@ void CorrolationFactory::getCorrolation(const CongressGroupDataList& congress, c
                             first in the evaluation since multiply by zero is often
                             optimized. */
                         // If the votes are too large to consider for the layout, treat it as 100%
-                        int voteDiff = votes[index1][index2];
+                        int voteDiff = votes.getRow(index1)[index2];
                         if (voteDiff < 0)
                             voteDiff = 1000;
                         if (index3 >= index4) {
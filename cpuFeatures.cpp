@@ -0,0 +1,72 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile also has
+    a link to the code depository)
+*/
+
+// Run time detection of processor vector instruction sets
+#include"cpuFeatures.h"
+
+#if defined(HAVE_X86_SIMD) && defined(_MSC_VER)
+#include<intrin.h>
+#endif
+
+// Queries the processor. Called once, by getFeatures()
+CpuFeatures::Features CpuFeatures::detectFeatures(void)
+{
+    Features features = { false, false, false, false };
+#if defined(HAVE_X86_SIMD) && defined(__GNUC__)
+    __builtin_cpu_init();
+    features._sse2 = __builtin_cpu_supports("sse2");
+    features._avx2 = __builtin_cpu_supports("avx2");
+    features._popcnt = __builtin_cpu_supports("popcnt");
+    features._avx512Popcnt = __builtin_cpu_supports("avx512f") &&
+                             __builtin_cpu_supports("avx512vpopcntdq");
+#elif defined(HAVE_X86_SIMD) && defined(_MSC_VER)
+    int registers[4];
+    __cpuid(registers, 0);
+    int maxLeaf = registers[0];
+    __cpuid(registers, 1);
+    features._sse2 = (registers[3] & (1 << 26)) != 0;
+    features._popcnt = (registers[2] & (1 << 23)) != 0;
+    /* AVX2 needs both processor support and operating system support for
+        saving the wider registers. The latter is the OSXSAVE bit plus the
+        register state mask. AVX-512 needs three more registers states saved */
+    bool osSavesXsave = (registers[2] & (1 << 27)) != 0;
+    bool osSavesAvx = osSavesXsave && ((_xgetbv(0) & 0x06) == 0x06);
+    bool osSavesAvx512 = osSavesXsave && ((_xgetbv(0) & 0xE6) == 0xE6);
+    if (osSavesAvx && (maxLeaf >= 7)) {
+        __cpuidex(registers, 7, 0);
+        features._avx2 = (registers[1] & (1 << 5)) != 0;
+        features._avx512Popcnt = osSavesAvx512 && ((registers[1] & (1 << 16)) != 0) && // AVX512F
+                                 ((registers[2] & (1 << 14)) != 0); // VPOPCNTDQ
+    }
+#endif
+    return features;
+}
+
+const CpuFeatures::Features& CpuFeatures::getFeatures(void)
+{
+    /* A function level static is initialized exactly once, on first use, even
+        with multiple threads. This avoids any dependence on the order of
+        global initialization */
+    static const Features features = detectFeatures();
+    return features;
+}
@@ -0,0 +1,110 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class reports which vector instruction sets the processor running the
+    program supports. The program is compiled for the lowest common denominator,
+    and the few routines that benefit from wider instructions pick a version at
+    run time based on these results. Detection is done once; the answers can't
+    change while the program runs */
+#ifndef CPU_FEATURES_H_INCLUDED
+#define CPU_FEATURES_H_INCLUDED
+
+// Vector code is only written for Intel compatible processors
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define HAVE_X86_SIMD 1
+#endif
+
+/* GCC and Clang refuse to compile intrinsics for instruction sets not enabled
+    on the command line, unless the function is marked as targeting them. MSVC
+    allows them anywhere. These macros hide the difference */
+#if defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_POPCNT __attribute__((target("popcnt")))
+#define TARGET_AVX512_POPCNT __attribute__((target("avx512f,avx512vpopcntdq")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#define TARGET_POPCNT
+#define TARGET_AVX512_POPCNT
+#endif
+
+class CpuFeatures
+{
+public:
+    static bool haveSse2(void);
+    static bool haveAvx2(void);
+    static bool havePopcnt(void); // Single instruction bit count of a 64 bit word
+    static bool haveAvx512Popcnt(void); // AVX-512 with bit counts of whole vectors (VPOPCNTDQ)
+
+private:
+    struct Features {
+        bool _sse2;
+        bool _avx2;
+        bool _popcnt;
+        bool _avx512Popcnt;
+    };
+
+    // Runs the detection the first time it is called, then returns the cached answer
+    static const Features& getFeatures(void);
+
+    // Queries the processor. Called once, by getFeatures()
+    static Features detectFeatures(void);
+};
+
+inline bool CpuFeatures::haveSse2(void)
+{
+    return getFeatures()._sse2;
+}
+
+inline bool CpuFeatures::haveAvx2(void)
+{
+    return getFeatures()._avx2;
+}
+
+inline bool CpuFeatures::havePopcnt(void)
+{
+    return getFeatures()._popcnt;
+}
+
+inline bool CpuFeatures::haveAvx512Popcnt(void)
+{
+    return getFeatures()._avx512Popcnt;
+}
+
+/* Index of the lowest set bit. The value must not be zero. Used by the vector
+    routines to turn comparison masks into positions */
+inline unsigned int lowestSetBit(unsigned int value)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(value);
+#else
+    unsigned int index = 0;
+    while (!(value & 1)) {
+        value >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+#endif // CPU_FEATURES_H_INCLUDED
@@ -0,0 +1,161 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+// The full record of merges made clustering Congresspeople
+#include<iostream>
+#include<vector>
+#include<algorithm>
+#include<limits>
+#include"congressData.h"
+#include"regionMapper.h"
+#include"voteDiffMatrix.h"
+#include"nearestNeighborChain.h"
+#include"clusterFactory.h"
+#include"clusterDistanceSums.h"
+#include"dendrogram.h"
+
+using std::cerr;
+using std::endl;
+using std::vector;
+
+/* Follows the links from a member to the cluster holding it now, which is named
+    by its lowest member. Shortens the links passed on the way */
+static unsigned short findMergedCluster(vector<unsigned short>& mergedInto, unsigned short cluster)
+{
+    while (mergedInto[cluster] != cluster) {
+        mergedInto[cluster] = mergedInto[mergedInto[cluster]];
+        cluster = mergedInto[cluster];
+    }
+    return cluster;
+}
+
+// Compares a threshold to the distance of a merge, for searching the list
+static bool isBelowStep(double noiseThreshold, const Dendrogram::Step& step)
+{
+    return noiseThreshold < step._distance;
+}
+
+Dendrogram::Dendrogram() : _memberCount(0), _steps()
+{
+}
+
+/* Clusters the members of the distance matrix with the given linkage, and records
+    every merge */
+void Dendrogram::build(const VoteDiffMatrix& distances, LinkageMatrix::Linkage linkage)
+{
+    NearestNeighborChain::MergeList merges;
+    NearestNeighborChain::findMerges(distances, linkage, merges);
+
+    _memberCount = distances.size();
+    _steps.clear();
+    _steps.reserve(merges.size());
+    vector<unsigned short> mergedInto(_memberCount), clusterSizes(_memberCount, 1);
+    unsigned short memberIndex;
+    for (memberIndex = 0; memberIndex < _memberCount; memberIndex++)
+        mergedInto[memberIndex] = memberIndex;
+    NearestNeighborChain::MergeList::const_iterator merge;
+    for (merge = merges.begin(); merge != merges.end(); merge++) {
+        unsigned short cluster1 = findMergedCluster(mergedInto, merge->_cluster1);
+        unsigned short cluster2 = findMergedCluster(mergedInto, merge->_cluster2);
+        if (cluster2 < cluster1)
+            std::swap(cluster1, cluster2);
+        mergedInto[cluster2] = cluster1;
+        clusterSizes[cluster1] += clusterSizes[cluster2];
+
+        Step newStep;
+        newStep._cluster1 = merge->_cluster1;
+        newStep._cluster2 = merge->_cluster2;
+        newStep._size = clusterSizes[cluster1];
+        newStep._distance = (float)merge->_distance;
+        _steps.push_back(newStep);
+    }
+}
+
+/* Returns the number of merges up to the given threshold, stopping early if the
+    minimum number of groups is reached */
+size_t Dendrogram::getCutStepCount(double noiseThreshold, unsigned short minGroups) const
+{
+    if (minGroups < 1)
+        minGroups = 1;
+    if (minGroups >= _memberCount)
+        return 0;
+    // The steps are in order by distance, so search for the first one past the threshold
+    size_t stepCount = std::upper_bound(_steps.begin(), _steps.end(), noiseThreshold,
+                                        isBelowStep) - _steps.begin();
+    return std::min(stepCount, (size_t)(_memberCount - minGroups));
+}
+
+// Returns the number of groups a cut at the threshold gives
+unsigned short Dendrogram::getGroupCount(double noiseThreshold, unsigned short minGroups) const
+{
+    return _memberCount - getCutStepCount(noiseThreshold, minGroups);
+}
+
+/* Finds the groups formClusters() returns for the given threshold and minimum
+    number of groups, in the same order */
+void Dendrogram::cut(double noiseThreshold, unsigned short minGroups, CongressGroupVector& groups,
+                     ClusterDistanceSums* distanceSums) const
+{
+    groups.clear();
+    if (_memberCount == 0)
+        return;
+
+    /* Join the clusters of each merge in turn. A cluster is always named by its lowest
+        member, so the groups end up in the same places formClusters() leaves them */
+    vector<unsigned short> mergedInto(_memberCount);
+    unsigned short memberIndex;
+    for (memberIndex = 0; memberIndex < _memberCount; memberIndex++)
+        mergedInto[memberIndex] = memberIndex;
+    size_t stepCount = getCutStepCount(noiseThreshold, minGroups);
+    size_t stepIndex;
+    for (stepIndex = 0; stepIndex < stepCount; stepIndex++) {
+        unsigned short cluster1 = findMergedCluster(mergedInto, _steps[stepIndex]._cluster1);
+        unsigned short cluster2 = findMergedCluster(mergedInto, _steps[stepIndex]._cluster2);
+        if (cluster2 < cluster1)
+            std::swap(cluster1, cluster2);
+        mergedInto[cluster2] = cluster1;
+        if (distanceSums)
+            distanceSums->merge(cluster1, cluster2);
+    }
+
+    groups.resize(_memberCount);
+    for (memberIndex = 0; memberIndex < _memberCount; memberIndex++)
+        groups[findMergedCluster(mergedInto, memberIndex)].insert(memberIndex);
+    ClusterFactory::removeEmptyGroups(groups);
+}
+
+// Finds the groups formed when merging stops at the given number of them
+void Dendrogram::cutToGroupCount(unsigned short groupCount, CongressGroupVector& groups) const
+{
+    cut(std::numeric_limits<double>::max(), groupCount, groups);
+}
+
+/* Outputs the number of groups for thresholds every given number of differences,
+    to help pick one */
+void Dendrogram::debugOutputGroupCounts(short thresholdStep) const
+{
+    if (thresholdStep < 1)
+        thresholdStep = 1;
+    short threshold;
+    for (threshold = 0; threshold <= 1000; threshold += thresholdStep)
+        cerr << "Threshold " << threshold << ": " << getGroupCount(threshold) << " groups" << endl;
+}
@@ -0,0 +1,115 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class records every merge of a clustering, from each Congressperson on
+    their own to everyone in one cluster, in the order they happen. The clusters
+    formClusters() returns are the first merges in this list, up to the noise
+    threshold or the minimum number of groups. Once it is recorded, clusters for
+    any other threshold or group count are a cut of the list, with no need to
+    cluster the vote differences again.
+
+    The record is small, one entry per merge holding the two clusters, the
+    distance, and the size of the merged cluster. A cut follows the merges from
+    the start, so it takes time in proportion to the number of members */
+#ifndef DENDROGRAM_H_INCLUDED
+#define DENDROGRAM_H_INCLUDED
+
+#include<vector>
+#include"voteDiffMatrix.h"
+#include"linkageMatrix.h"
+
+/* NOTE: Uses CongressGroupVector from clusterFactory.h. The header is not included
+    here; callers need it anyway to do anything with the results */
+
+// Only used by pointer, so callers that don't need it don't need the header
+class ClusterDistanceSums;
+
+using std::vector;
+
+class Dendrogram
+{
+public:
+    /* One merge. Each cluster is named by a member of it, the lowest at the time it
+        was merged. The distance is on the scale of the vote differences */
+    struct Step {
+        unsigned short _cluster1;
+        unsigned short _cluster2;
+        unsigned short _size; // Members in the merged cluster
+        float _distance;
+    };
+
+    Dendrogram();
+
+    /* Clusters the members of the distance matrix with the given linkage, and records
+        every merge */
+    void build(const VoteDiffMatrix& distances,
+               LinkageMatrix::Linkage linkage = LinkageMatrix::linkageComplete);
+
+    // Number of members clustered
+    unsigned short getMemberCount(void) const;
+
+    // The merges, in the order they happen, and so in order by distance
+    size_t getStepCount(void) const;
+    const Step& getStep(size_t step) const;
+
+    /* Returns the number of merges up to the given threshold, stopping early if
+        the minimum number of groups is reached. Does not depend on the number of
+        members, so trying many thresholds is cheap */
+    size_t getCutStepCount(double noiseThreshold, unsigned short minGroups = 1) const;
+
+    // Returns the number of groups a cut at the threshold gives
+    unsigned short getGroupCount(double noiseThreshold, unsigned short minGroups = 1) const;
+
+    /* Finds the groups formClusters() returns for the given threshold and minimum
+        number of groups, in the same order. If totals of the member differences are
+        given, they are merged along with the groups */
+    void cut(double noiseThreshold, unsigned short minGroups, CongressGroupVector& groups,
+             ClusterDistanceSums* distanceSums = 0) const;
+
+    // Finds the groups formed when merging stops at the given number of them
+    void cutToGroupCount(unsigned short groupCount, CongressGroupVector& groups) const;
+
+    /* Outputs the number of groups for thresholds every given number of differences,
+        to help pick one */
+    void debugOutputGroupCounts(short thresholdStep = 25) const;
+
+private:
+    unsigned short _memberCount;
+    vector<Step> _steps;
+};
+
+inline unsigned short Dendrogram::getMemberCount(void) const
+{
+    return _memberCount;
+}
+
+inline size_t Dendrogram::getStepCount(void) const
+{
+    return _steps.size();
+}
+
+inline const Dendrogram::Step& Dendrogram::getStep(size_t step) const
+{
+    return _steps[step];
+}
+
+#endif // DENDROGRAM_H_INCLUDED
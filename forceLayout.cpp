@@ -228,12 +228,7 @@ void ForceLayout::makeLayout(const VoteDiffMatrix& votes, const CongressGroupDat
             // Find sum of forces on this point
             for (index2 = 0; index2 < congressPositions.size(); index2++)
                 if (index1 != index2) {
-                    // Vote difference array is ragged
-                    short voteDifference;
-                    if (index1 < index2)
-                        voteDifference = votes.at(index2).at(index1);
-                    else
-                        voteDifference = votes.at(index1).at(index2);
+                    short voteDifference = votes.get(index1, index2);
                     forces[index1] += findForce(congressGroupData[index1],
                                                 congressGroupData[index2],
                                                 voteDifference, congressPositions[index1],
@@ -0,0 +1,500 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile also has
+    a link to the code depository)
+*/
+
+// Make session graphs from the data files
+#include<string>
+#include<vector>
+#include<fstream>
+#include<sstream>
+#include<iostream>
+#include<thread>
+#include<exception>
+#include<algorithm>
+#include<utility>
+#include<map>
+#include<climits>
+#include<stdexcept>
+#include"congressData.h"
+#include"rollCallManifest.h"
+#include"regionMapper.h"
+#include"voteFactory.h"
+#include"voteCache.h"
+#include"clusterFactory.h"
+#include"sketchClusterFactory.h"
+#include"forceLayout.h"
+#include"matrixExport.h"
+#include"graphFactory.h"
+
+using std::string;
+using std::vector;
+using std::map;
+using std::ofstream;
+using std::stringstream;
+using std::thread;
+using std::exception_ptr;
+using std::cerr;
+using std::endl;
+using std::ios_base;
+
+// One session of a batch run
+struct GraphFactory::SessionJob
+{
+    short _firstYear;
+    const CongressData::CongressPersonList* _congress; // From the shared parse of people.xml
+    exception_ptr _error; // Set if the session failed
+};
+
+/* Makes the graph of the session in the manifest. The Congresspeople of the
+    session are read from people.xml unless the list is given or saved results are
+    used. Throws ios_base::failure if the data files can't be read */
+void GraphFactory::makeGraph(SessionGraph& graph, unique_ptr<CongressData>& congress,
+                             const RollCallManifest& rollCalls, const RegionMapper& regions,
+                             unsigned int workerCount,
+                             const CongressData::CongressPersonList* sessionCongress)
+{
+    SessionVotes sessionVotes;
+    getSessionVotes(sessionVotes, congress, rollCalls, workerCount, sessionCongress);
+    VoteDiffMatrix voteResults;
+    VoteFactory::normalizeVoteMatrix(sessionVotes, voteResults);
+    makeGroupGraph(graph, voteResults, *congress, regions);
+}
+
+/* Clusters the Congresspeople by the given vote differences and lays out the
+    groups. The differences are moved into the graph */
+void GraphFactory::makeGroupGraph(SessionGraph& graph, VoteDiffMatrix& memberVotes,
+                                  const CongressData& congress, const RegionMapper& regions)
+{
+    /* Cluster Congresspeople whose votes are close enough that differences are meaningless.
+        The vote differences between the clusters are found as they merge */
+    CongressGroupVector clusteredCongress;
+    ClusterFactory::formClusters(memberVotes, clusteredCongress, congress, 150, 20, false,
+                                 ClusterFactory::clusterNearestNeighborChain,
+                                 LinkageMatrix::linkageComplete, 0, &graph._groupVotes);
+
+    /* Drop large vote differences in the results afterward, they add lots
+        of compute without affecting the final results much */
+    VoteFactory::filterLargeMismatch(graph._groupVotes, ClusterFactory::meaningfulDifferenceLimit);
+
+    // Find how the groups distribute based on wanted characteristics
+    graph._groupData.clear();
+    ClusterFactory::getClusterCongressData(clusteredCongress, congress, regions, graph._groupData);
+
+    // Layout the groups based on vote similarity
+    graph._groupPositions.clear();
+    ForceLayout::makeLayout(graph._groupVotes, graph._groupData, graph._groupPositions);
+
+    /* To avoid cluttering the finalgraph, only retain the strongest correlations
+        for output */
+    VoteFactory::filterLargeMismatch(graph._groupVotes, 350);
+
+    // Members who vote alike are next to each other in this order, which exports smaller
+    ClusterFactory::getMemberOrder(clusteredCongress, graph._memberOrder);
+    graph._memberVotes = std::move(memberVotes);
+}
+
+/* Gets the votes of the session in the manifest, along with its Congresspeople.
+    Throws ios_base::failure if the data files can't be read */
+void GraphFactory::getSessionVotes(SessionVotes& sessionVotes, unique_ptr<CongressData>& congress,
+                                   const RollCallManifest& rollCalls, unsigned int workerCount,
+                                   const CongressData::CongressPersonList* sessionCongress)
+{
+    /* Past sessions never change, so use the results saved by an earlier run if the
+        data files are the same. A session in progress only adds files, so just read
+        those. Otherwise load in data to process, with debug off */
+    CongressData::CongressPersonList cachedCongress;
+    RollCallManifest::RollCallsByYear newRollCalls;
+    if (VoteCache::load(rollCalls, cachedCongress, sessionVotes, newRollCalls)) {
+        cerr << "Using saved vote data for " << rollCalls.getFirstYear() << "-"
+             << rollCalls.getLastYear() << endl;
+        congress.reset(new CongressData(cachedCongress));
+        if (!newRollCalls.empty()) {
+            VoteFactory::addVotes(sessionVotes, *congress, rollCalls, newRollCalls, workerCount);
+            VoteCache::save(rollCalls, *congress, sessionVotes);
+        }
+    }
+    else {
+        if (sessionCongress)
+            congress.reset(new CongressData(*sessionCongress));
+        else
+            congress.reset(new CongressData(rollCalls.getFirstYear()));
+
+        // Find vote differcnes between every member of Congress
+        VoteFactory::readVotes(sessionVotes, *congress, rollCalls, workerCount);
+        VoteCache::save(rollCalls, *congress, sessionVotes);
+    }
+}
+
+/* Makes the graphs of every session starting between the two years, and saves
+    each in a text file. Returns the number of sessions that failed */
+unsigned int GraphFactory::makeGraphs(short firstSessionYear, short lastSessionYear,
+                                      unsigned int workerCount)
+{
+    // Parsing people.xml is the one step every session shares, so do it once up front
+    CongressData::CongressPersonsBySession sessionCongress;
+    CongressData::readSessions(firstSessionYear, lastSessionYear, sessionCongress);
+    RegionMapper regions;
+
+    vector<SessionJob> jobs;
+    unsigned int failCount = 0;
+    short year;
+    for (year = firstSessionYear; year <= lastSessionYear; year += 2) {
+        CongressData::CongressPersonsBySession::const_iterator congress = sessionCongress.find(year);
+        if (congress == sessionCongress.end()) {
+            cerr << "No Congresspeople found for session " << year << "-" << (year + 1) << endl;
+            failCount++;
+        }
+        else {
+            SessionJob job;
+            job._firstYear = year;
+            job._congress = &congress->second;
+            jobs.push_back(job);
+        }
+    }
+    if (jobs.empty())
+        return failCount;
+
+    /* Sessions are independent, so each thread takes whole sessions, and any
+        threads beyond one per session help read the votes of each. Clustering
+        and layout are single threaded, so giving every session a thread of its
+        own is faster than giving each session every thread in turn */
+    if (workerCount < 1)
+        workerCount = 1;
+    unsigned int sessionThreadCount = std::min<size_t>(workerCount, jobs.size());
+    unsigned int sessionWorkerCount = workerCount / sessionThreadCount;
+
+    atomic<size_t> nextJob(0);
+    vector<thread> threads;
+    unsigned int index;
+    // This thread works too, so start one fewer
+    for (index = 1; index < sessionThreadCount; index++)
+        threads.push_back(thread(makeGraphsWorker, std::ref(jobs), std::ref(nextJob),
+                                 std::cref(regions), sessionWorkerCount));
+    makeGraphsWorker(jobs, nextJob, regions, sessionWorkerCount);
+    for (index = 0; index < threads.size(); index++)
+        threads[index].join();
+
+    // Errors were written to standard error as they happened, so just count them
+    for (index = 0; index < jobs.size(); index++)
+        if (jobs[index]._error) {
+            cerr << "Graph for session " << jobs[index]._firstYear << "-"
+                 << (jobs[index]._firstYear + 1) << " failed" << endl;
+            failCount++;
+        }
+    return failCount;
+}
+
+/* Worker thread body. Takes sessions from the shared list until none are left,
+    making and saving the graph of each. Errors are saved in the list */
+void GraphFactory::makeGraphsWorker(vector<SessionJob>& jobs, atomic<size_t>& nextJob,
+                                    const RegionMapper& regions, unsigned int sessionWorkerCount)
+{
+    size_t jobIndex;
+    while ((jobIndex = nextJob++) < jobs.size()) {
+        SessionJob& job = jobs[jobIndex];
+        try {
+            RollCallManifest rollCalls(job._firstYear, job._firstYear + 1);
+            SessionGraph graph;
+            unique_ptr<CongressData> congress;
+            makeGraph(graph, congress, rollCalls, regions, sessionWorkerCount, job._congress);
+
+            stringstream fileName;
+            fileName << "graph" << rollCalls.getFirstYear() << "-" << rollCalls.getLastYear() << ".txt";
+            saveGraph(graph, *congress, rollCalls, fileName.str());
+
+            /* The exact differences compress to about a byte each in group order, so
+                nothing is gained by rounding them to one byte codes */
+            stringstream matrixFileName;
+            matrixFileName << "matrix" << rollCalls.getFirstYear() << "-" << rollCalls.getLastYear() << ".crvm";
+            MatrixExport::save(graph._memberVotes, matrixFileName.str(), MatrixExport::valueShort, true,
+                               graph._memberOrder);
+            cerr << "Saved graph of " << rollCalls.getRollCallCount() << " roll calls in "
+                 << fileName.str() << " and its differences in " << matrixFileName.str() << endl;
+        }
+        catch (...) {
+            // Other sessions can still succeed, so keep going
+            job._error = std::current_exception();
+        }
+    }
+}
+
+/* Reads the votes of every session starting between the two years and joins them
+    into one set of Congresspeople. Returns the number of sessions that failed */
+unsigned int GraphFactory::readSessionVotes(short firstSessionYear, short lastSessionYear,
+                                            unsigned int workerCount,
+                                            CongressData::CongressPersonList& members,
+                                            VoteBitMatrix& passVotes, VoteBitMatrix& voted)
+{
+    members.clear();
+    CongressData::CongressPersonsBySession sessionCongress;
+    CongressData::readSessions(firstSessionYear, lastSessionYear, sessionCongress);
+
+    /* The total number of roll calls sets the size of the joined bits, so read every
+        session first. Each keeps its vote bits and where its members are in the list */
+    vector<SessionVotes> sessionVotes;
+    vector<vector<unsigned short> > sessionMembers;
+    map<int, unsigned short> memberIndexes; // By person id
+    unsigned int rollCallCapacity = 0;
+    unsigned int failCount = 0;
+    short year;
+    for (year = firstSessionYear; year <= lastSessionYear; year += 2) {
+        CongressData::CongressPersonsBySession::const_iterator congress = sessionCongress.find(year);
+        if (congress == sessionCongress.end()) {
+            cerr << "No Congresspeople found for session " << year << "-" << (year + 1) << endl;
+            failCount++;
+            continue;
+        }
+        SessionVotes votes;
+        unique_ptr<CongressData> congressData;
+        try {
+            RollCallManifest rollCalls(year, year + 1);
+            getSessionVotes(votes, congressData, rollCalls, workerCount, &congress->second);
+        }
+        catch (std::exception&) {
+            // The error was reported when thrown. The other sessions can still be joined
+            cerr << "Votes for session " << year << "-" << (year + 1) << " failed" << endl;
+            failCount++;
+            continue;
+        }
+
+        /* The rows follow the list the votes were read with, which is the saved one if
+            the saved results were used */
+        vector<unsigned short> rowMembers(congressData->getSize());
+        unsigned short row;
+        for (row = 0; row < congressData->getSize(); row++) {
+            const CongressData::CongressPerson& person = congressData->getData(row);
+            map<int, unsigned short>::iterator member = memberIndexes.find(person._refNo);
+            if (member == memberIndexes.end()) {
+                // CongressData marks a missing person with SHRT_MAX, so no index may reach it
+                if (members.size() >= SHRT_MAX) {
+                    stringstream errorText;
+                    errorText << "Too many Congresspeople to join sessions " << firstSessionYear << "-"
+                              << (lastSessionYear + 1) << ", limit is " << SHRT_MAX;
+                    cerr << errorText.str() << endl;
+                    throw std::out_of_range(errorText.str());
+                }
+                member = memberIndexes.insert(std::make_pair(person._refNo,
+                                                             (unsigned short)members.size())).first;
+                members.push_back(person);
+            }
+            else
+                members[member->second] = person; // Party and state of their latest session
+            rowMembers[row] = member->second;
+        }
+
+        // Only the vote bits are joined, so free the differences now
+        votes._differences.assign(0);
+        votes._bothVoted.assign(0);
+        rollCallCapacity += votes._voted.getWordsPerRow() * VoteBitMatrix::bitsPerWord;
+        sessionVotes.push_back(std::move(votes));
+        sessionMembers.push_back(std::move(rowMembers));
+    } // For each session
+
+    /* Each session starts on a new word, so its rows are copied a word at a time. The
+        roll calls between sessions have no votes, so they change no differences */
+    passVotes.reset(members.size(), rollCallCapacity);
+    voted.reset(members.size(), rollCallCapacity);
+    size_t sessionIndex;
+    for (sessionIndex = 0; sessionIndex < sessionVotes.size(); sessionIndex++) {
+        const SessionVotes& votes = sessionVotes[sessionIndex];
+        while ((voted.getRollCallCount() % VoteBitMatrix::bitsPerWord) != 0) {
+            passVotes.addRollCall();
+            voted.addRollCall();
+        }
+        unsigned int firstWord = voted.getRollCallCount() / VoteBitMatrix::bitsPerWord;
+        unsigned int rollCallIndex;
+        for (rollCallIndex = 0; rollCallIndex < votes._voted.getRollCallCount(); rollCallIndex++) {
+            passVotes.addRollCall();
+            voted.addRollCall();
+        }
+
+        unsigned int wordCount = votes._voted.getWordsPerRow();
+        const vector<unsigned short>& rowMembers = sessionMembers[sessionIndex];
+        unsigned short row;
+        for (row = 0; row < rowMembers.size(); row++) {
+            std::copy(votes._passVotes.getRow(row), votes._passVotes.getRow(row) + wordCount,
+                      passVotes.getRow(rowMembers[row]) + firstWord);
+            std::copy(votes._voted.getRow(row), votes._voted.getRow(row) + wordCount,
+                      voted.getRow(rowMembers[row]) + firstWord);
+        }
+    } // For each session read
+    return failCount;
+}
+
+/* Groups the Congresspeople of every session starting between the two years across
+    sessions, and saves the groups in a text file. Returns the number of sessions
+    that failed */
+unsigned int GraphFactory::makeSessionGroups(short firstSessionYear, short lastSessionYear,
+                                             unsigned int workerCount)
+{
+    CongressData::CongressPersonList members;
+    VoteBitMatrix passVotes, voted;
+    unsigned int failCount = readSessionVotes(firstSessionYear, lastSessionYear, workerCount,
+                                              members, passVotes, voted);
+    if (members.empty()) {
+        cerr << "No votes found for sessions " << firstSessionYear << "-" << (lastSessionYear + 1) << endl;
+        return std::max(failCount, 1u);
+    }
+
+    /* A graph of one session measures disagreement over all its roll calls. Across
+        sessions every member missed nearly all of them, so that puts everyone far
+        apart; only roll calls both members voted on mean anything, which is the
+        absence corrected metric. The threshold is the number the session graph uses,
+        but here it is the share of disagreement on votes both cast, so it is stricter
+        for members who missed many votes and the same for those who missed few */
+    CongressData congress(members);
+    CongressGroupVector groups;
+    SketchClusterFactory::formClusters(passVotes, voted, groups, 150, 0,
+                                       VoteFactory::metricAbsenceCorrected);
+    CongressGroupDataList groupData;
+    RegionMapper regions;
+    ClusterFactory::getClusterCongressData(groups, congress, regions, groupData);
+
+    stringstream title, fileName;
+    title << "Congress voting similiarity groups " << firstSessionYear << "-" << (lastSessionYear + 1);
+    fileName << "groups" << firstSessionYear << "-" << (lastSessionYear + 1) << ".txt";
+    saveGroups(groupData, congress, title.str(), fileName.str());
+    cerr << "Saved " << groupData.size() << " groups of " << members.size() << " Congresspeople in "
+         << fileName.str() << endl;
+    return failCount;
+}
+
+/* Makes the graphs of a series of windows of roll calls moving through the session
+    in the manifest, and saves each in a text file. Returns the number of frames */
+size_t GraphFactory::makeWindowGraphs(const RollCallManifest& rollCalls, const RegionMapper& regions,
+                                      unsigned int windowRollCalls, unsigned int stepRollCalls,
+                                      unsigned int workerCount)
+{
+    SessionVotes sessionVotes;
+    unique_ptr<CongressData> congress;
+    getSessionVotes(sessionVotes, congress, rollCalls, workerCount, 0);
+    vector<VoteDiffMatrix> frames;
+    VoteFactory::getWindowMatrices(sessionVotes, windowRollCalls, stepRollCalls, frames,
+                                   VoteFactory::metricDisagreement, workerCount);
+
+    size_t frameIndex;
+    for (frameIndex = 0; frameIndex < frames.size(); frameIndex++) {
+        SessionGraph graph;
+        makeGroupGraph(graph, frames[frameIndex], *congress, regions);
+
+        stringstream frameName, fileName;
+        frameName << " window " << (frameIndex + 1) << " of " << frames.size();
+        fileName << "graph" << rollCalls.getFirstYear() << "-" << rollCalls.getLastYear() << "-"
+                 << (frameIndex + 1) << ".txt";
+        saveGraph(graph, *congress, rollCalls, fileName.str(), frameName.str());
+        cerr << "Saved graph of" << frameName.str() << " in " << fileName.str() << endl;
+    }
+    return frames.size();
+}
+
+/* Writes a session graph as text: each group with its position, party counts and
+    members, then the links between groups. Throws ios_base::failure on error */
+void GraphFactory::saveGraph(const SessionGraph& graph, const CongressData& congress,
+                             const RollCallManifest& rollCalls, const string& fileName,
+                             const string& frameName)
+{
+    ofstream file(fileName.c_str());
+    if (!file.is_open()) {
+        stringstream errorText;
+        errorText << "Could not create graph file " << fileName;
+        cerr << errorText.str() << endl;
+        throw ios_base::failure(errorText.str());
+    }
+
+    file << "Congress voting similiarity " << rollCalls.getFirstYear() << "-"
+         << rollCalls.getLastYear() << frameName << endl;
+    file << "groups " << graph._groupData.size() << endl;
+    unsigned short index, index2;
+    for (index = 0; index < graph._groupData.size(); index++) {
+        const CongressGroupData& group = graph._groupData[index];
+        file << "group " << index << " position " << graph._groupPositions.at(index).getX()
+             << " " << graph._groupPositions.at(index).getY() << " members " << group.getCount()
+             << " parties";
+        vector<short>::const_iterator party;
+        for (party = group._parties.begin(); party != group._parties.end(); party++)
+            file << " " << *party;
+        file << endl;
+
+        writeGroupMembers(file, group, congress);
+    }
+
+    // Links are the group pairs whose differences survived filtering, as drawn
+    file << "links" << endl;
+    for (index = 0; index < graph._groupVotes.size(); index++)
+        for (index2 = 0; index2 < index; index2++)
+            if (graph._groupVotes.get(index, index2) > 0)
+                file << index2 << " " << index << " " << graph._groupVotes.get(index, index2) << endl;
+
+    file.close();
+    if (file.fail()) {
+        stringstream errorText;
+        errorText << "Could not write graph file " << fileName;
+        cerr << errorText.str() << endl;
+        throw ios_base::failure(errorText.str());
+    }
+}
+
+/* Writes groups of Congresspeople as text: the title, then each group with its
+    party counts and members. Throws ios_base::failure on error */
+void GraphFactory::saveGroups(const CongressGroupDataList& groupData, const CongressData& congress,
+                              const string& title, const string& fileName)
+{
+    ofstream file(fileName.c_str());
+    if (!file.is_open()) {
+        stringstream errorText;
+        errorText << "Could not create groups file " << fileName;
+        cerr << errorText.str() << endl;
+        throw ios_base::failure(errorText.str());
+    }
+
+    file << title << endl;
+    file << "groups " << groupData.size() << endl;
+    unsigned short index;
+    for (index = 0; index < groupData.size(); index++) {
+        const CongressGroupData& group = groupData[index];
+        file << "group " << index << " members " << group.getCount() << " parties";
+        vector<short>::const_iterator party;
+        for (party = group._parties.begin(); party != group._parties.end(); party++)
+            file << " " << *party;
+        file << endl;
+        writeGroupMembers(file, group, congress);
+    }
+
+    file.close();
+    if (file.fail()) {
+        stringstream errorText;
+        errorText << "Could not write groups file " << fileName;
+        cerr << errorText.str() << endl;
+        throw ios_base::failure(errorText.str());
+    }
+}
+
+// Writes the members of a group, one per line
+void GraphFactory::writeGroupMembers(ofstream& file, const CongressGroupData& group,
+                                     const CongressData& congress)
+{
+    CongressGroup::const_iterator member;
+    for (member = group._group.begin(); member != group._group.end(); member++) {
+        const CongressData::CongressPerson& person = congress.getData(*member);
+        file << "    " << person._name << " (" << person._party << "-" << person._state << ")" << endl;
+    }
+}
@@ -0,0 +1,153 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class runs every step from the data files of a session to its finished
+    graph: reading the votes (or loading them from the cache), clustering the
+    Congresspeople, and laying out the groups. The display draws one session, but
+    the graphs of many sessions can also be made at once and saved as text; see
+    makeGraphs(). So can the graphs of windows of roll calls moving through one
+    session; see makeWindowGraphs(). The members of many sessions can also be
+    grouped together, across sessions, and the groups saved as text; see
+    makeSessionGroups() */
+#ifndef GRAPH_FACTORY_H_INCLUDED
+#define GRAPH_FACTORY_H_INCLUDED
+
+#include<memory>
+#include<atomic>
+#include<fstream>
+
+/* NOTE: Uses string, CongressData, RollCallManifest, RegionMapper, VoteDiffMatrix,
+    VoteBitMatrix, SessionVotes, and the group and layout types. Their headers are
+    not included here; callers need them anyway to do anything with the results */
+
+using std::unique_ptr;
+using std::atomic;
+using std::ofstream;
+
+// Everything needed to draw the graph of a session, and to export its differences
+struct SessionGraph
+{
+    CongressGroupDataList _groupData; // Groups of Congresspeople who vote alike
+    VoteDiffMatrix _groupVotes; // Vote differences between groups, only the strongest kept
+    LayoutVector _groupPositions;
+    VoteDiffMatrix _memberVotes; // Vote differences between every pair of Congresspeople
+    vector<unsigned short> _memberOrder; // Congresspeople group by group, for exporting
+};
+
+class GraphFactory
+{
+public:
+    /* Makes the graph of the session in the manifest. The Congresspeople of the
+        session are read from people.xml unless the list is given or saved results are
+        used. The Congress data is returned because the groups refer to it by index.
+        The given number of threads read the votes. Throws ios_base::failure if the data
+        files can't be read */
+    static void makeGraph(SessionGraph& graph, unique_ptr<CongressData>& congress,
+                          const RollCallManifest& rollCalls, const RegionMapper& regions,
+                          unsigned int workerCount,
+                          const CongressData::CongressPersonList* sessionCongress = 0);
+
+    /* Makes the graphs of every session starting between the two years, and saves
+        each in a text file named graph[first year]-[last year].txt. The differences
+        between every pair of Congresspeople are saved with it, in the compressed form of
+        MatrixExport with exact values and the rows group by group, in a file named
+        matrix[first year]-[last year].crvm. people.xml holds every session, so it is
+        read once for all of them. The given number of threads
+        work on several sessions at once. A session that fails is reported and the
+        rest continue. Returns the number of sessions that failed */
+    static unsigned int makeGraphs(short firstSessionYear, short lastSessionYear,
+                                   unsigned int workerCount);
+
+    /* Makes the graphs of a series of windows of roll calls moving through the session
+        in the manifest, to show how voting changes within it. The windows are chosen as
+        VoteFactory::getWindowMatrices() describes. Each frame is clustered and laid out
+        the same way as a whole session, on its own, and saved in a text file named
+        graph[first year]-[last year]-[frame].txt, numbered from 1. The given number of
+        threads read and count the votes. Returns the number of frames. Throws
+        ios_base::failure if the data files can't be read or a graph can't be written */
+    static size_t makeWindowGraphs(const RollCallManifest& rollCalls, const RegionMapper& regions,
+                                   unsigned int windowRollCalls, unsigned int stepRollCalls,
+                                   unsigned int workerCount);
+
+    /* Writes a session graph as text: each group with its position, party counts and
+        members, then the links between groups. A frame name, if given, follows the years
+        in the title. Throws ios_base::failure on error */
+    static void saveGraph(const SessionGraph& graph, const CongressData& congress,
+                          const RollCallManifest& rollCalls, const string& fileName,
+                          const string& frameName = string());
+
+    /* Reads the votes of every session starting between the two years and joins them
+        into one set of Congresspeople, so members of different sessions can be clustered
+        together. A person in several sessions is one member, found by their person id,
+        with the party and state of their last session. Each session's roll calls follow
+        those of the one before, starting on a new word of the vote bits. The votes are
+        read as for makeGraph(), from saved results where they exist, by the given number
+        of threads. A session that fails is reported and left out. Throws out_of_range if
+        there are too many Congresspeople to number. Returns the number of sessions that
+        failed */
+    static unsigned int readSessionVotes(short firstSessionYear, short lastSessionYear,
+                                         unsigned int workerCount,
+                                         CongressData::CongressPersonList& members,
+                                         VoteBitMatrix& passVotes, VoteBitMatrix& voted);
+
+    /* Groups the Congresspeople of every session starting between the two years across
+        sessions with SketchClusterFactory, and saves the groups in a text file named
+        groups[first year]-[last year].txt. The groups are summarized as for a session
+        graph, but not laid out; thousands of groups are too many to draw. Returns the
+        number of sessions that failed, which are left out of the groups */
+    static unsigned int makeSessionGroups(short firstSessionYear, short lastSessionYear,
+                                          unsigned int workerCount);
+
+private:
+    // One session of a batch run
+    struct SessionJob;
+
+    /* Clusters the Congresspeople by the given vote differences and lays out the
+        groups. The differences are moved into the graph */
+    static void makeGroupGraph(SessionGraph& graph, VoteDiffMatrix& memberVotes,
+                               const CongressData& congress, const RegionMapper& regions);
+
+    /* Gets the votes of the session in the manifest, along with its Congresspeople.
+        Past sessions use the results saved by an earlier run if the data files are the
+        same, reading only roll calls added since. Otherwise the Congresspeople are read
+        from people.xml unless the list is given. Throws ios_base::failure if the data
+        files can't be read */
+    static void getSessionVotes(SessionVotes& sessionVotes, unique_ptr<CongressData>& congress,
+                                const RollCallManifest& rollCalls, unsigned int workerCount,
+                                const CongressData::CongressPersonList* sessionCongress);
+
+    /* Worker thread body. Takes sessions from the shared list until none are left,
+        making and saving the graph of each. Errors are saved in the list */
+    static void makeGraphsWorker(vector<SessionJob>& jobs, atomic<size_t>& nextJob,
+                                 const RegionMapper& regions, unsigned int sessionWorkerCount);
+
+    /* Writes groups of Congresspeople as text: the title, then each group with its
+        party counts and members. Throws ios_base::failure on error */
+    static void saveGroups(const CongressGroupDataList& groupData, const CongressData& congress,
+                           const string& title, const string& fileName);
+
+    // Writes the members of a group, one per line
+    static void writeGroupMembers(ofstream& file, const CongressGroupData& group,
+                                  const CongressData& congress);
+};
+
+#endif // GRAPH_FACTORY_H_INCLUDED
@@ -0,0 +1,224 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile also has
+    a link to the code depository)
+*/
+
+/* Key searching for the XML parser. The vector versions compare the first and
+    last chars of the key against a full register of text positions at once,
+    giving a bit mask of candidate matches. Only candidates get a full compare */
+#include<string>
+#include<string_view>
+#include<vector>
+#include<sstream>
+#include<iostream>
+#include<chrono>
+#include<cstring>
+#include"cpuFeatures.h"
+#include"keySearch.h"
+
+#ifdef HAVE_X86_SIMD
+#include<immintrin.h>
+#endif
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::stringstream;
+using std::cerr;
+using std::endl;
+
+/* Checks the chars of a candidate match between the first and last. Those two
+    were already compared by the caller */
+static inline bool matchKeyMiddle(const char* candidate, const char* key, size_t keySize)
+{
+    return ((keySize <= 2) || (memcmp(candidate + 1, key + 1, keySize - 2) == 0));
+}
+
+/* Plain C++ version. memchr() finds the candidates for the first char; the
+    library version is already well optimized for this */
+size_t KeySearch::findScalar(const char* text, size_t textSize, const char* key, size_t keySize)
+{
+    if (keySize > textSize)
+        return textSize;
+    size_t lastStart = textSize - keySize; // Final position where the key still fits
+    size_t index = 0;
+    while (index <= lastStart) {
+        const char* candidate = (const char*)memchr(text + index, key[0], lastStart - index + 1);
+        if (candidate == 0)
+            return textSize;
+        index = candidate - text;
+        if ((candidate[keySize - 1] == key[keySize - 1]) &&
+            matchKeyMiddle(candidate, key, keySize))
+            return index;
+        index++;
+    }
+    return textSize;
+}
+
+#ifdef HAVE_X86_SIMD
+
+size_t TARGET_SSE2 KeySearch::findSse2(const char* text, size_t textSize, const char* key, size_t keySize)
+{
+    if (keySize > textSize)
+        return textSize;
+    const __m128i firstChar = _mm_set1_epi8(key[0]);
+    const __m128i lastChar = _mm_set1_epi8(key[keySize - 1]);
+
+    /* Each pass checks 16 possible start positions. The load for the last char
+        reaches keySize - 1 past the load for the first, so stop while both
+        loads still fit within the text. The tail goes to the scalar version */
+    size_t index = 0;
+    size_t positionLimit = textSize - keySize + 1; // Number of possible start positions
+    for (; (index + 16) <= positionLimit; index += 16) {
+        __m128i blockFirst = _mm_loadu_si128((const __m128i*)(text + index));
+        __m128i blockLast = _mm_loadu_si128((const __m128i*)(text + index + keySize - 1));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, firstChar),
+                                                                          _mm_cmpeq_epi8(blockLast, lastChar)));
+        while (mask != 0) {
+            unsigned int offset = lowestSetBit(mask);
+            if (matchKeyMiddle(text + index + offset, key, keySize))
+                return index + offset;
+            mask &= mask - 1; // Clear the candidate just tested
+        }
+    } // For each block of positions
+    return index + findScalar(text + index, textSize - index, key, keySize);
+}
+
+size_t TARGET_AVX2 KeySearch::findAvx2(const char* text, size_t textSize, const char* key, size_t keySize)
+{
+    if (keySize > textSize)
+        return textSize;
+    const __m256i firstChar = _mm256_set1_epi8(key[0]);
+    const __m256i lastChar = _mm256_set1_epi8(key[keySize - 1]);
+
+    // Same as the SSE2 version, but with 32 positions per pass
+    size_t index = 0;
+    size_t positionLimit = textSize - keySize + 1; // Number of possible start positions
+    for (; (index + 32) <= positionLimit; index += 32) {
+        __m256i blockFirst = _mm256_loadu_si256((const __m256i*)(text + index));
+        __m256i blockLast = _mm256_loadu_si256((const __m256i*)(text + index + keySize - 1));
+        __m256i candidates = _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, firstChar),
+                                              _mm256_cmpeq_epi8(blockLast, lastChar));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(candidates);
+        while (mask != 0) {
+            unsigned int offset = lowestSetBit(mask);
+            if (matchKeyMiddle(text + index + offset, key, keySize))
+                return index + offset;
+            mask &= mask - 1; // Clear the candidate just tested
+        }
+    } // For each block of positions
+    // Lines are short, so the tail is often most of the line. Use SSE2 for it
+    return index + findSse2(text + index, textSize - index, key, keySize);
+}
+
+#endif // HAVE_X86_SIMD
+
+// Picks the routine. Called once, by getSearchMethod()
+KeySearch::SearchMethod KeySearch::selectSearchMethod(void)
+{
+#ifdef HAVE_X86_SIMD
+    if (CpuFeatures::haveAvx2())
+        return &findAvx2;
+    else if (CpuFeatures::haveSse2())
+        return &findSse2;
+#endif
+    return &findScalar;
+}
+
+// Returns the best search routine for this processor. Chosen once
+KeySearch::SearchMethod KeySearch::getSearchMethod(void)
+{
+    static const SearchMethod method = selectSearchMethod();
+    return method;
+}
+
+/* Times every search version available on this processor against the
+    standard library find(), using text built to resemble a roll call file.
+    Results are written to standard error */
+void KeySearch::debugBenchmark(unsigned int iterations)
+{
+    /* Build the text of a roll call vote. The voter lines are what matters, so
+        use a typical House's worth of them */
+    vector<string> lines;
+    lines.push_back("<roll where=\"house\" session=\"112\" year=\"2011\" roll=\"1\" source=\"house.gov\">");
+    lines.push_back("  <option key=\"+\">Yea</option>");
+    lines.push_back("  <option key=\"-\">Nay</option>");
+    unsigned short index;
+    for (index = 0; index < 435; index++) {
+        stringstream line;
+        line << "  <voter id=\"" << (400001 + index) << "\" vote=\"" << ((index % 3) ? '+' : '-')
+             << "\" value=\"" << ((index % 3) ? "Yea" : "Nay") << "\" state=\"CA\" district=\""
+             << (index % 53) << "\"/>";
+        lines.push_back(line.str());
+    }
+    lines.push_back("</roll>");
+
+    const string voterKey("<voter id=");
+    const string voteKey(" vote=");
+
+    // The methods to compare. The standard library is handled separately below
+    vector<std::pair<string, SearchMethod> > methods;
+    methods.push_back(std::make_pair(string("scalar"), &findScalar));
+#ifdef HAVE_X86_SIMD
+    if (CpuFeatures::haveSse2())
+        methods.push_back(std::make_pair(string("SSE2"), &findSse2));
+    if (CpuFeatures::haveAvx2())
+        methods.push_back(std::make_pair(string("AVX2"), &findAvx2));
+#endif
+
+    typedef std::chrono::steady_clock Clock;
+    unsigned long searchCount = (unsigned long)iterations * lines.size() * 2;
+
+    /* Sum the found positions so the compiler can't discard the searches. The
+        sums also double as a check that every method finds the same things */
+    size_t libraryTotal = 0;
+    Clock::time_point start = Clock::now();
+    unsigned int pass;
+    for (pass = 0; pass < iterations; pass++)
+        for (index = 0; index < lines.size(); index++) {
+            libraryTotal += lines[index].find(voterKey, 1);
+            libraryTotal += lines[index].find(voteKey, 1);
+        }
+    double libraryTime = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    cerr << "std::string::find: " << (libraryTime / searchCount) << " ns per search" << endl;
+
+    unsigned short methodIndex;
+    for (methodIndex = 0; methodIndex < methods.size(); methodIndex++) {
+        SearchMethod method = methods[methodIndex].second;
+        size_t total = 0;
+        start = Clock::now();
+        for (pass = 0; pass < iterations; pass++)
+            for (index = 0; index < lines.size(); index++) {
+                // Translate the 'not found' value to match the library
+                const string& line = lines[index];
+                size_t result = method(line.data() + 1, line.size() - 1, voterKey.data(), voterKey.size());
+                total += (result >= line.size() - 1) ? string::npos : result + 1;
+                result = method(line.data() + 1, line.size() - 1, voteKey.data(), voteKey.size());
+                total += (result >= line.size() - 1) ? string::npos : result + 1;
+            }
+        double methodTime = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        cerr << methods[methodIndex].first << ": " << (methodTime / searchCount) << " ns per search, "
+             << (libraryTime / methodTime) << "x library speed";
+        if (total != libraryTotal)
+            cerr << " WARNING: results differ from library";
+        cerr << endl;
+    } // For each method
+}
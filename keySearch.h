@@ -0,0 +1,86 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class finds XML keys within a line of text. It is the innermost loop of
+    file parsing: every voter record in a roll call file requires two searches.
+    The search compares the first and last chars of the key against a whole
+    vector register of text at once, and only does a full comparison where both
+    match. The keys used by this program start with '<' or ' ' and end with '=',
+    so false matches are rare.
+
+    Versions exist for AVX2, SSE2, and plain C++. The best one the processor
+    supports is chosen the first time a search is done */
+#ifndef KEY_SEARCH_H_INCLUDED
+#define KEY_SEARCH_H_INCLUDED
+
+#include<string_view>
+#include<cstddef>
+#include"cpuFeatures.h" // Defines HAVE_X86_SIMD
+
+using std::string_view;
+
+class KeySearch
+{
+public:
+    /* Finds the first occurance of the key in the text at or after the start
+        position. Returns string_view::npos if not found, matching the behavior
+        of the standard library find() */
+    static size_t find(string_view text, string_view key, size_t start = 0);
+
+    /* Times every search version available on this processor against the
+        standard library find(), using text built to resemble a roll call file.
+        Results are written to standard error */
+    static void debugBenchmark(unsigned int iterations = 2000);
+
+private:
+    typedef size_t (*SearchMethod)(const char* text, size_t textSize,
+                                   const char* key, size_t keySize);
+
+    // The search routines. Each returns the offset of the match, or textSize if none
+    static size_t findScalar(const char* text, size_t textSize, const char* key, size_t keySize);
+#ifdef HAVE_X86_SIMD
+    static size_t findSse2(const char* text, size_t textSize, const char* key, size_t keySize);
+    static size_t findAvx2(const char* text, size_t textSize, const char* key, size_t keySize);
+#endif
+
+    // Returns the best search routine for this processor. Chosen once
+    static SearchMethod getSearchMethod(void);
+
+    // Picks the routine. Called once, by getSearchMethod()
+    static SearchMethod selectSearchMethod(void);
+};
+
+inline size_t KeySearch::find(string_view text, string_view key, size_t start)
+{
+    if ((start > text.size()) || (key.size() > (text.size() - start)))
+        return string_view::npos;
+    if (key.empty())
+        return start;
+    size_t result = getSearchMethod()(text.data() + start, text.size() - start,
+                                      key.data(), key.size());
+    if (result >= (text.size() - start))
+        return string_view::npos;
+    else
+        return result + start;
+}
+
+#endif // KEY_SEARCH_H_INCLUDED
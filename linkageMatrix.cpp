@@ -0,0 +1,96 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+// Distances between clusters, updated with the Lance-Williams formula
+#include<vector>
+#include<cmath>
+#include"linkageMatrix.h"
+
+using std::vector;
+
+// Sets up one cluster per member, with the distances between members
+LinkageMatrix::LinkageMatrix(const VoteDiffMatrix& distances, Linkage linkage)
+    : _distances(), _clusterSizes(distances.size(), 1), _linkage(linkage)
+{
+    unsigned short clusterCount = distances.size();
+    if (clusterCount < 2)
+        return;
+    _distances.reserve(getRowOffset(clusterCount));
+    unsigned short row, column;
+    for (row = 1; row < clusterCount; row++) {
+        const short* distanceRow = distances.getRow(row);
+        for (column = 0; column < row; column++) {
+            double distance = distanceRow[column];
+            if (_linkage == linkageWard)
+                distance *= distance;
+            _distances.push_back(distance);
+        }
+    }
+}
+
+// Converts a distance from the matrix to the scale of vote differences
+double LinkageMatrix::getMergeDistance(double distance) const
+{
+    if (_linkage == linkageWard)
+        return std::sqrt(distance);
+    else
+        return distance;
+}
+
+/* Merges the second cluster into the first, updating the distances from the first
+    to the other clusters listed */
+void LinkageMatrix::merge(unsigned short keptCluster, unsigned short mergedCluster,
+                          const vector<unsigned short>& activeClusters)
+{
+    double keptSize = _clusterSizes[keptCluster];
+    double mergedSize = _clusterSizes[mergedCluster];
+    double mergeDistance = get(keptCluster, mergedCluster);
+
+    // Coefficients of the Lance-Williams formula. Only Ward's depend on the other cluster
+    double keptFactor = 0.5, mergedFactor = 0.5, betweenFactor = 0.0, spreadFactor = 0.0;
+    if (_linkage == linkageComplete)
+        spreadFactor = 0.5;
+    else if (_linkage == linkageSingle)
+        spreadFactor = -0.5;
+    else if (_linkage == linkageAverage) {
+        keptFactor = keptSize / (keptSize + mergedSize);
+        mergedFactor = mergedSize / (keptSize + mergedSize);
+    }
+
+    vector<unsigned short>::const_iterator active;
+    for (active = activeClusters.begin(); active != activeClusters.end(); active++) {
+        if ((*active == keptCluster) || (*active == mergedCluster))
+            continue;
+        double& keptDistance = _distances[getOffset(*active, keptCluster)];
+        double mergedDistance = _distances[getOffset(*active, mergedCluster)];
+        if (_linkage == linkageWard) {
+            double otherSize = _clusterSizes[*active];
+            double totalSize = keptSize + mergedSize + otherSize;
+            keptFactor = (keptSize + otherSize) / totalSize;
+            mergedFactor = (mergedSize + otherSize) / totalSize;
+            betweenFactor = -otherSize / totalSize;
+        }
+        keptDistance = (keptFactor * keptDistance) + (mergedFactor * mergedDistance) +
+            (betweenFactor * mergeDistance) + (spreadFactor * std::fabs(keptDistance - mergedDistance));
+    }
+    _clusterSizes[keptCluster] += _clusterSizes[mergedCluster];
+}
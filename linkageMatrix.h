@@ -0,0 +1,121 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class holds the distances between clusters while they are merged, and
+    updates them in place after each merge. The linkage decides how far a newly
+    merged cluster is from the rest:
+    1.  Complete: the largest difference between a member of each cluster. Every
+        member of a cluster is close to every other, so clusters stay tight
+    2.  Single: the smallest difference between a member of each. Clusters grow
+        as chains of close members, and can end up far wider than the threshold
+    3.  Average: the mean difference over every pair of members of the two
+    4.  Ward: how much merging the clusters increases the spread of members around
+        their centers. It favors merging small clusters, so clusters come out more
+        even in size. Distances are squared for this and the square root reported,
+        so a pair of single members still merges at their vote difference
+
+    All of these can be found from the distances to the two merged clusters, the
+    distance between them, and the cluster sizes, with the Lance-Williams formula:
+    d(k, i+j) = a(i) d(k,i) + a(j) d(k,j) + b d(i,j) + c |d(k,i) - d(k,j)|
+    The coefficients depend on the linkage. This means a merge only visits one
+    row and column of the matrix, never the member differences themselves.
+
+    Average and Ward distances are fractions, so the matrix holds doubles, packed
+    like VoteDiffMatrix but without the diagonal. Complete and single linkage only
+    ever pick one of the original differences, which doubles hold exactly */
+#ifndef LINKAGE_MATRIX_H_INCLUDED
+#define LINKAGE_MATRIX_H_INCLUDED
+
+#include<vector>
+#include<cstddef>
+#include"voteDiffMatrix.h"
+
+using std::vector;
+
+class LinkageMatrix
+{
+public:
+    enum Linkage { linkageComplete, linkageSingle, linkageAverage, linkageWard };
+
+    // Sets up one cluster per member, with the distances between members
+    LinkageMatrix(const VoteDiffMatrix& distances, Linkage linkage);
+
+    // Number of clusters the matrix started with
+    size_t size(void) const;
+
+    /* Gets the distance between two different clusters, in the units used to compare
+        them. Indexes are not checked */
+    double get(unsigned short cluster1, unsigned short cluster2) const;
+
+    /* Direct access to one row. Only columns below the row number are valid. Indexes
+        are not checked */
+    const double* getRow(unsigned short cluster) const;
+
+    // Converts a distance from the matrix to the scale of vote differences
+    double getMergeDistance(double distance) const;
+
+    /* Merges the second cluster into the first, updating the distances from the first
+        to the other clusters listed. The row and column of the second are no longer used */
+    void merge(unsigned short keptCluster, unsigned short mergedCluster,
+               const vector<unsigned short>& activeClusters);
+
+private:
+    vector<double> _distances;
+    vector<unsigned int> _clusterSizes;
+    Linkage _linkage;
+
+    // Location of the first value of a row
+    static size_t getRowOffset(size_t row);
+
+    // Location of the value for a pair of different clusters, in either order
+    static size_t getOffset(unsigned short cluster1, unsigned short cluster2);
+};
+
+inline size_t LinkageMatrix::getRowOffset(size_t row)
+{
+    return (row * (row - 1)) / 2;
+}
+
+inline size_t LinkageMatrix::getOffset(unsigned short cluster1, unsigned short cluster2)
+{
+    if (cluster1 < cluster2)
+        return getRowOffset(cluster2) + cluster1;
+    else
+        return getRowOffset(cluster1) + cluster2;
+}
+
+inline size_t LinkageMatrix::size(void) const
+{
+    return _clusterSizes.size();
+}
+
+inline double LinkageMatrix::get(unsigned short cluster1, unsigned short cluster2) const
+{
+    return _distances[getOffset(cluster1, cluster2)];
+}
+
+inline const double* LinkageMatrix::getRow(unsigned short cluster) const
+{
+    return _distances.data() + getRowOffset(cluster);
+}
+
+#endif // LINKAGE_MATRIX_H_INCLUDED
@@ -23,18 +23,23 @@
 
 // Main driver for the Congressional Vote Similiarity program
 #include <stdlib.h>
+#include <string.h>
 #include <utility>
 #include <GL/glut.h>
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <thread>
+#include <memory>
 #include "congressData.h"
+#include "rollCallManifest.h"
 #include "regionMapper.h"
 #include "voteFactory.h"
 #include "clusterFactory.h"
 #include "corrolation.h"
 #include "forceLayout.h"
 #include "displayGroup.h"
+#include "graphFactory.h"
 
 using std::cerr;
 using std::endl;
@@ -86,7 +91,7 @@ void display()
     glBegin(GL_LINES);
     for (index = 0; index < clusteredVotes.size(); index++)
         for (index2 = 0; index2 < index; index2++)
-            if (clusteredVotes.at(index).at(index2) > 0)
+            if (clusteredVotes.get(index, index2) > 0)
                 DisplayGroup::drawLink(congressGroupData.at(index), congressGroupData.at(index2),
                                         congressPositions.at(index), congressPositions.at(index2));
     glEnd();
@@ -94,24 +99,14 @@ void display()
     glFlush();
 }
 
-int main(int argc, char** argv)
+/* Gets the start year of a Congressional session. It can be specified
+    as either a session number or the starting year. Note that the starting
+    year is the year AFTER the election.
+    SEMI-HACK: If the value has less than four digits, assume its a session
+    number. This will be valid for at least the next thousand years */
+short getSessionStartYear(const char* session)
 {
-    glutInit(&argc, argv);
-    glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA);
-
-    // Need to compute the data before creating the window
-    /* Get the wanted Congressional session to graph. It can be specified
-        as either a session number or the starting year. Note that the starting
-        year is the year AFTER the election. If no year is specified, use the
-        most recent.
-        SEMI-HACK: If the value has less than four digits, assume its a session
-        number. This will be valid for at least the next thousand years */
-    if (argc != 2) {
-        cerr << "Invalid arguments. Specify starting year or number of Congressioanl session" << endl;
-        exit(1);
-    }
-
-    short firstYear = atoi(argv[1]);
+    short firstYear = atoi(session);
     if (firstYear < 1000)
         /* The files are in terms of years, so need to convert. Sessions are numbered
             every two years, starting with the first Congress. This procudes a
@@ -121,40 +116,128 @@ int main(int argc, char** argv)
         firstYear = (firstYear * 2) + 1787;
     /* If the year specified is even, assume the last year of the wanted session
         was specified. Technically an error, but easy to deal with */
-    else if ((firstYear % 2) != 0)
+    else if ((firstYear % 2) == 0)
         firstYear--;
-    short lastYear = firstYear + 1; // Get other year of session
-
-    // Load in data to process, with debug off
-    CongressData congress(firstYear);
-    RegionMapper regions;
+    return firstYear;
+}
 
-    // Find vote differcnes between every member of Congress
-    VoteDiffMatrix voteResults;
-    VoteFactory::getVoteMatrix(voteResults, congress, firstYear, lastYear);
+int main(int argc, char** argv)
+{
+    // Need to compute the data before creating the window
+    /* Get the wanted Congressional session to graph, as a session number or start
+        year. If no year is specified, use the most recent. A range of sessions,
+        given as the first and last separated by a dash, makes the graph of every
+        session in it and saves them in files instead of drawing one. A range
+        separated by a plus sign instead groups the members of every session in
+        it together, across sessions, and saves the groups in a file. A session
+        followed by a slash and a number of roll calls graphs windows of that many
+        roll calls moving through the session, and saves them in files; another
+        slash and number sets how far each window moves, 64 roll calls if not given.
+        The number of threads to use can follow it */
+    if ((argc != 2) && (argc != 3)) {
+        cerr << "Invalid arguments. Specify starting year or number of Congressioanl session, "
+             << "or a range of them separated by a dash (graph each session) or a plus sign "
+             << "(group members across sessions), or a session followed by /window[/step] "
+             << "in roll calls (graph windows of the session), and optionally the number of threads"
+             << endl;
+        exit(1);
+    }
 
-    /* Print the matrix. Have a bunch of congressmen with no votes, should be treated as
-        no similarity with anyone else */
+    /* Reading the vote files and comparing every pair of members are the slowest
+        steps, so use every processor for them unless told otherwise. The count is
+        zero if the library can't tell, so fall back to one thread */
+    unsigned int workerCount = std::thread::hardware_concurrency();
+    if (argc == 3) {
+        int wantedCount = atoi(argv[2]);
+        if (wantedCount < 1) {
+            cerr << "Invalid number of threads " << argv[2] << endl;
+            exit(1);
+        }
+        workerCount = wantedCount;
+    }
+    if (workerCount < 1)
+        workerCount = 1;
 
-    // Cluster Congresspeople whose votes are close enough that differences are meaningless
-    CongressGroupVector clusteredCongress;
-    ClusterFactory::formClusters(voteResults, clusteredCongress, congress, 150, 20);
+    // A batch never opens a window, so it must run before GLUT needs a display
+    const char* groupRangeEnd = strchr(argv[1], '+');
+    if (groupRangeEnd) {
+        short firstYear = getSessionStartYear(argv[1]);
+        short lastYear = getSessionStartYear(groupRangeEnd + 1);
+        if (lastYear < firstYear) {
+            cerr << "Invalid session range " << argv[1] << endl;
+            exit(1);
+        }
+        try {
+            if (GraphFactory::makeSessionGroups(firstYear, lastYear, workerCount))
+                exit(1);
+        }
+        catch (std::exception&) {
+            // The error was reported when thrown
+            exit(1);
+        }
+        return EXIT_SUCCESS;
+    }
+    const char* windowStart = strchr(argv[1], '/');
+    if (windowStart) {
+        short firstYear = getSessionStartYear(argv[1]);
+        int windowRollCalls = atoi(windowStart + 1);
+        const char* stepStart = strchr(windowStart + 1, '/');
+        int stepRollCalls = stepStart ? atoi(stepStart + 1) : 64;
+        if ((windowRollCalls < 1) || (stepRollCalls < 1)) {
+            cerr << "Invalid roll call window " << argv[1] << endl;
+            exit(1);
+        }
+        try {
+            RollCallManifest rollCalls(firstYear, firstYear + 1);
+            RegionMapper regions;
+            GraphFactory::makeWindowGraphs(rollCalls, regions, windowRollCalls, stepRollCalls, workerCount);
+        }
+        catch (std::exception&) {
+            // The error was reported when thrown
+            exit(1);
+        }
+        return EXIT_SUCCESS;
+    }
+    const char* rangeEnd = strchr(argv[1], '-');
+    if (rangeEnd) {
+        short firstYear = getSessionStartYear(argv[1]);
+        short lastYear = getSessionStartYear(rangeEnd + 1);
+        if (lastYear < firstYear) {
+            cerr << "Invalid session range " << argv[1] << endl;
+            exit(1);
+        }
+        try {
+            if (GraphFactory::makeGraphs(firstYear, lastYear, workerCount))
+                exit(1);
+        }
+        catch (std::exception&) {
+            // The error was reported when thrown
+            exit(1);
+        }
+        return EXIT_SUCCESS;
+    }
 
-    // Recalculate the vote differences to be between the clusters
-    /* Drop large vote differences in the results afterward, they add lots
-        of compute without affecting the final results much */
-    ClusterFactory::getClusterDistanceMap(voteResults, clusteredCongress, clusteredVotes);
-    VoteFactory::filterLargeMismatch(clusteredVotes, ClusterFactory::meaningfulDifferenceLimit);
+    glutInit(&argc, argv);
+    glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA);
 
-    // Find how the groups distribute based on wanted characteristics
-    ClusterFactory::getClusterCongressData(clusteredCongress, congress, regions, congressGroupData);
+    short firstYear = getSessionStartYear(argv[1]);
+    short lastYear = firstYear + 1; // Get other year of session
 
-    // Layout the groups based on vote similarity
-    ForceLayout::makeLayout(clusteredVotes, congressGroupData, congressPositions);
+    RollCallManifest rollCalls(firstYear, lastYear);
+    RegionMapper regions;
+    cerr << "Found " << rollCalls.getRollCallCount() << " roll call files for " << firstYear
+         << "-" << lastYear;
+    if (rollCalls.isBundled())
+        cerr << " in " << rollCalls.getBundle().getFileName();
+    cerr << endl;
 
-    /* To avoid cluttering the finalgraph, only retain the strongest correlations
-        for output */
-    VoteFactory::filterLargeMismatch(clusteredVotes, 350);
+    // Read the votes, cluster the Congresspeople, and lay out the groups
+    SessionGraph graph;
+    std::unique_ptr<CongressData> congress;
+    GraphFactory::makeGraph(graph, congress, rollCalls, regions, workerCount);
+    congressGroupData.swap(graph._groupData);
+    clusteredVotes = graph._groupVotes;
+    congressPositions.swap(graph._groupPositions);
 
     glutInitWindowPosition(-1, -1);
     glutInitWindowSize(640, 640);
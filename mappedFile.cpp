@@ -0,0 +1,154 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile also has
+    a link to the code depository)
+*/
+
+/* Read only memory mapping of whole files. The program was written for Windows,
+    so that API is supported along with the POSIX one used everywhere else */
+#include<string>
+#include"mappedFile.h"
+
+#ifdef _WIN32
+#include<windows.h>
+#else
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<fcntl.h>
+#include<unistd.h>
+#endif
+
+using std::string;
+
+/* Empty files can't be mapped (both APIs reject a zero length mapping) but are
+    still valid files. Point them at this instead so callers never see NULL */
+static const char emptyFileData[1] = { '\0' };
+
+MappedFile::MappedFile()
+{
+    _data = 0;
+    _size = 0;
+    _isOpen = false;
+#ifdef _WIN32
+    _fileHandle = INVALID_HANDLE_VALUE;
+    _mapHandle = 0;
+#else
+    _fileHandle = -1;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const string& fileName)
+{
+    close();
+    _fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (_fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(_fileHandle, &fileSize)) {
+        close();
+        return false;
+    }
+    _size = (size_t)fileSize.QuadPart;
+    if (_size == 0)
+        _data = emptyFileData;
+    else {
+        _mapHandle = CreateFileMappingA(_fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+        if (_mapHandle == 0) {
+            close();
+            return false;
+        }
+        _data = (const char*)MapViewOfFile(_mapHandle, FILE_MAP_READ, 0, 0, 0);
+        if (_data == 0) {
+            close();
+            return false;
+        }
+    } // File has contents
+    _isOpen = true;
+    return true;
+}
+
+void MappedFile::close(void)
+{
+    if ((_data != 0) && (_data != emptyFileData))
+        UnmapViewOfFile(_data);
+    if (_mapHandle != 0)
+        CloseHandle(_mapHandle);
+    if (_fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(_fileHandle);
+    _data = 0;
+    _size = 0;
+    _isOpen = false;
+    _fileHandle = INVALID_HANDLE_VALUE;
+    _mapHandle = 0;
+}
+
+#else // POSIX
+
+bool MappedFile::open(const string& fileName)
+{
+    close();
+    _fileHandle = ::open(fileName.c_str(), O_RDONLY);
+    if (_fileHandle < 0)
+        return false;
+
+    struct stat fileStatus;
+    if (fstat(_fileHandle, &fileStatus) != 0) {
+        close();
+        return false;
+    }
+    _size = (size_t)fileStatus.st_size;
+    if (_size == 0)
+        _data = emptyFileData;
+    else {
+        void* mapping = mmap(0, _size, PROT_READ, MAP_PRIVATE, _fileHandle, 0);
+        if (mapping == MAP_FAILED) {
+            close();
+            return false;
+        }
+        // Every file is parsed front to back, so tell the kernel to read ahead aggressively
+        madvise(mapping, _size, MADV_SEQUENTIAL);
+        _data = (const char*)mapping;
+    } // File has contents
+    _isOpen = true;
+    return true;
+}
+
+void MappedFile::close(void)
+{
+    if ((_data != 0) && (_data != emptyFileData))
+        munmap((void*)_data, _size);
+    if (_fileHandle >= 0)
+        ::close(_fileHandle);
+    _data = 0;
+    _size = 0;
+    _isOpen = false;
+    _fileHandle = -1;
+}
+
+#endif // Platform specific mapping
@@ -0,0 +1,92 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class maps an entire file into memory, read only. The data files used
+    by this program are read start to finish exactly once, so letting the
+    operating system page them in directly avoids copying every line into a
+    string buffer first. The file contents are exposed as a raw char pointer
+    plus size; callers are responsible for staying inside those limits. */
+#ifndef MAPPED_FILE_H_INCLUDED
+#define MAPPED_FILE_H_INCLUDED
+
+#include<string>
+#include<cstddef>
+
+using std::string;
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile(); // Unmaps any open file
+
+    /* Maps the given file into memory. Returns true if succeeded, else false.
+        Any previously open file is closed first */
+    bool open(const string& fileName);
+
+    // Unmaps the current file, if any
+    void close(void);
+
+    // Returns true if a file is currently mapped
+    bool isOpen(void) const;
+
+    // File contents. Only valid while the file is open
+    const char* getData(void) const;
+    size_t getSize(void) const;
+
+private:
+    const char* _data;
+    size_t _size;
+    bool _isOpen;
+
+    /* Operating system handles. Windows needs both the file and the mapping
+        object; everyone else only needs the descriptor. Stored as generic
+        types so this header does not drag in the system headers */
+#ifdef _WIN32
+    void* _fileHandle;
+    void* _mapHandle;
+#else
+    int _fileHandle;
+#endif
+
+    /* Copying is prohibited; the same mapping would be released twice.
+        Declared private and never defined */
+    MappedFile(const MappedFile& other);
+    MappedFile& operator=(const MappedFile& other);
+};
+
+inline bool MappedFile::isOpen(void) const
+{
+    return _isOpen;
+}
+
+inline const char* MappedFile::getData(void) const
+{
+    return _data;
+}
+
+inline size_t MappedFile::getSize(void) const
+{
+    return _size;
+}
+
+#endif // MAPPED_FILE_H_INCLUDED
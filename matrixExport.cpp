@@ -0,0 +1,333 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+
+// Compact export of difference matrices
+#include<string>
+#include<vector>
+#include<fstream>
+#include<sstream>
+#include<iostream>
+#include<stdexcept>
+#include<algorithm>
+#include<cstdint>
+#include<climits>
+#include"matrixExport.h"
+
+using std::string;
+using std::vector;
+using std::ofstream;
+using std::stringstream;
+using std::cerr;
+using std::endl;
+using std::ios_base;
+
+static const char exportMagic[4] = { 'C', 'R', 'V', 'M' };
+static const unsigned char exportVersion = 1;
+static const unsigned char compressedFlag = 1;
+static const unsigned char memberOrderFlag = 2;
+static const short maxValue = 1000;
+
+// Appends a number to the results as little endian bytes
+static void appendNumber(vector<char>& results, uint32_t value, unsigned int byteCount)
+{
+    unsigned int byteIndex;
+    for (byteIndex = 0; byteIndex < byteCount; byteIndex++)
+        results.push_back((char)((value >> (8 * byteIndex)) & 0xFF));
+}
+
+// Reads a little endian number
+static uint32_t readNumber(const unsigned char* data, unsigned int byteCount)
+{
+    uint32_t value = 0;
+    unsigned int byteIndex;
+    for (byteIndex = 0; byteIndex < byteCount; byteIndex++)
+        value |= (uint32_t)data[byteIndex] << (8 * byteIndex);
+    return value;
+}
+
+// Reports compressed codes that can't be decoded. Throws ios_base::failure
+static void throwCorrupt(size_t row)
+{
+    stringstream errorText;
+    errorText << "Matrix export codes corrupt at row " << row;
+    cerr << errorText.str() << endl;
+    throw ios_base::failure(errorText.str());
+}
+
+/* Predicts a code from the ones to its left, above, and above left, given the
+    current and previous rows of codes */
+int MatrixExport::predictCode(const vector<int>& codes, const vector<int>& lastCodes,
+                              size_t row, size_t column, int filteredCode)
+{
+    if (column == 0)
+        return (row > 1) ? lastCodes[0] : 0;
+    // The row above ends one column sooner
+    if (column == (row - 1))
+        return codes[column - 1];
+
+    /* Assume the change from the left neighbor matches the change above it. It
+        holds well within a group of members who vote alike */
+    int prediction = codes[column - 1] + lastCodes[column] - lastCodes[column - 1];
+    if (prediction < 0)
+        return 0;
+    else if (prediction > filteredCode)
+        return filteredCode;
+    else
+        return prediction;
+}
+
+/* Writes the matrix in export form to the results, replacing their contents.
+    The rows are written in the given order of members, if any. Throws
+    out_of_range if any value is over 1000, or the order does not list every
+    member once */
+void MatrixExport::encode(const VoteDiffMatrix& matrix, ValueSize valueSize, bool compress,
+                          vector<char>& results, const vector<unsigned short>& memberOrder)
+{
+    size_t memberCount = matrix.size();
+    bool haveOrder = !memberOrder.empty();
+    if (haveOrder) {
+        vector<bool> found(memberCount, false);
+        size_t index;
+        for (index = 0; index < memberOrder.size(); index++)
+            if ((memberOrder.size() != memberCount) || (memberOrder[index] >= memberCount) ||
+                found[memberOrder[index]])
+                throw std::out_of_range("MatrixExport member order does not list every member once");
+            else
+                found[memberOrder[index]] = true;
+    }
+
+    /* One byte holds 0 to 250 in steps of 4, and two bytes 0 to 1000 exactly.
+        Filtered values get the next code */
+    unsigned int unitSize = (valueSize == valueByte) ? 4 : 1;
+    int filteredCode = (maxValue / unitSize) + 1;
+
+    results.assign(exportMagic, exportMagic + sizeof(exportMagic));
+    results.push_back((char)exportVersion);
+    results.push_back((char)valueSize);
+    results.push_back((char)((compress ? compressedFlag : 0) | (haveOrder ? memberOrderFlag : 0)));
+    results.push_back((char)unitSize);
+    appendNumber(results, (uint32_t)memberCount, 4);
+    appendNumber(results, 0, 4); // Size of the codes, filled in at the end
+    size_t row, column;
+    if (haveOrder)
+        for (row = 0; row < memberCount; row++)
+            appendNumber(results, memberOrder[row], 2);
+    size_t codeStart = results.size();
+    if (!compress)
+        results.reserve(codeStart + (valueSize * ((memberCount * (memberCount - 1)) / 2)));
+
+    // Codes of the current and previous rows, for the predictions
+    vector<int> codes(memberCount, 0);
+    vector<int> lastCodes(memberCount, 0);
+    for (row = 1; row < memberCount; row++) {
+        for (column = 0; column < row; column++) {
+            short value = haveOrder ? matrix.get(memberOrder[row], memberOrder[column]) :
+                                      matrix.get(row, column);
+            if (value > maxValue)
+                throw std::out_of_range("MatrixExport value over 1000");
+            int code;
+            if (value < 0)
+                code = filteredCode;
+            else
+                code = (value + (unitSize / 2)) / unitSize;
+
+            if (!compress)
+                appendNumber(results, code, valueSize);
+            else {
+                /* Store the difference from the prediction. Fold the sign into the
+                    lowest bit, so small differences either way are small numbers,
+                    then write 7 bits per byte with the top bit set if more follow */
+                int difference = code - predictCode(codes, lastCodes, row, column, filteredCode);
+                uint32_t folded = (difference < 0) ? ((uint32_t)(-difference) * 2) - 1 : (uint32_t)difference * 2;
+                while (folded >= 0x80) {
+                    results.push_back((char)((folded & 0x7F) | 0x80));
+                    folded >>= 7;
+                }
+                results.push_back((char)folded);
+                codes[column] = code;
+            }
+        } // For each column
+        codes.swap(lastCodes);
+    } // For each row
+
+    uint32_t codeBytes = (uint32_t)(results.size() - codeStart);
+    unsigned int byteIndex;
+    for (byteIndex = 0; byteIndex < 4; byteIndex++)
+        results[headerSize - 4 + byteIndex] = (char)((codeBytes >> (8 * byteIndex)) & 0xFF);
+}
+
+/* Writes the matrix in export form to a file. Throws out_of_range as for
+    encode(), and ios_base::failure if the file can't be written */
+void MatrixExport::save(const VoteDiffMatrix& matrix, const string& fileName,
+                        ValueSize valueSize, bool compress, const vector<unsigned short>& memberOrder)
+{
+    vector<char> data;
+    encode(matrix, valueSize, compress, data, memberOrder);
+
+    ofstream file(fileName.c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
+    if (file.is_open()) {
+        file.write(&data[0], data.size());
+        file.close();
+    }
+    if (file.fail()) {
+        stringstream errorText;
+        errorText << "Could not write matrix export file " << fileName;
+        cerr << errorText.str() << endl;
+        throw ios_base::failure(errorText.str());
+    }
+}
+
+/* Prints the size of the matrix in every export form, and what a plain dump
+    of both halves of it would take, to standard error */
+void MatrixExport::debugOutputSizes(const VoteDiffMatrix& matrix, const vector<unsigned short>& memberOrder)
+{
+    size_t plainSize = matrix.size() * matrix.size() * sizeof(short);
+    cerr << matrix.size() << " members, plain dump " << plainSize << " bytes" << endl;
+    const ValueSize sizes[2] = { valueByte, valueShort };
+    unsigned int sizeIndex, compress;
+    vector<char> data;
+    for (sizeIndex = 0; sizeIndex < 2; sizeIndex++)
+        for (compress = 0; compress < 2; compress++) {
+            encode(matrix, sizes[sizeIndex], compress != 0, data, memberOrder);
+            cerr << sizes[sizeIndex] << " byte codes" << (compress ? ", compressed: " : ": ")
+                 << data.size() << " bytes, " << ((double)plainSize / data.size()) << "x smaller" << endl;
+        }
+}
+
+MatrixExportReader::MatrixExportReader() : _memberRows(), _rowMembers()
+{
+    _codes = 0;
+    _codeBytes = 0;
+    _memberCount = 0;
+    _valueSize = 1;
+    _unitSize = 1;
+    _filteredCode = 0;
+    _isCompressed = false;
+}
+
+/* Checks the header of an export held in memory. The data is not copied,
+    so it must outlast the reader. Returns false if it is not a valid export */
+bool MatrixExportReader::open(const char* data, size_t size)
+{
+    const unsigned char* header = reinterpret_cast<const unsigned char*>(data);
+    _codes = 0;
+    _memberCount = 0;
+    _memberRows.clear();
+    _rowMembers.clear();
+    if ((size < MatrixExport::headerSize) ||
+        !std::equal(exportMagic, exportMagic + sizeof(exportMagic), data) ||
+        (header[4] != exportVersion) || ((header[5] != 1) && (header[5] != 2)) ||
+        ((header[6] & ~(compressedFlag | memberOrderFlag)) != 0) || (header[7] == 0))
+        return false;
+
+    size_t memberCount = readNumber(header + 8, 4);
+    size_t codeBytes = readNumber(header + 12, 4);
+    // Members are numbered in an unsigned short, as everywhere else
+    if (memberCount > USHRT_MAX)
+        return false;
+    size_t orderBytes = (header[6] & memberOrderFlag) ? 2 * memberCount : 0;
+    size_t valueCount = (memberCount > 0) ? (memberCount * (memberCount - 1)) / 2 : 0;
+    bool isCompressed = (header[6] & compressedFlag) != 0;
+    /* Uncompressed codes are looked up directly, so they must all be there. Every
+        compressed code takes at least a byte, so a count too short for them is corrupt,
+        and is caught before decoding allocates a matrix for them */
+    if (((orderBytes + codeBytes) > (size - MatrixExport::headerSize)) ||
+        (!isCompressed && (codeBytes != (valueCount * header[5]))) ||
+        (isCompressed && (codeBytes < valueCount)))
+        return false;
+
+    // The order must list every member once. Keep it both ways for lookups
+    if (orderBytes) {
+        const unsigned char* order = header + MatrixExport::headerSize;
+        _rowMembers.resize(memberCount);
+        _memberRows.assign(memberCount, USHRT_MAX);
+        size_t row;
+        for (row = 0; row < memberCount; row++) {
+            unsigned short member = (unsigned short)readNumber(order + (2 * row), 2);
+            if ((member >= memberCount) || (_memberRows[member] != USHRT_MAX)) {
+                _memberRows.clear();
+                _rowMembers.clear();
+                return false;
+            }
+            _rowMembers[row] = member;
+            _memberRows[member] = (unsigned short)row;
+        }
+    }
+
+    _codes = header + MatrixExport::headerSize + orderBytes;
+    _codeBytes = codeBytes;
+    _memberCount = memberCount;
+    _valueSize = header[5];
+    _unitSize = header[7];
+    _filteredCode = (maxValue / _unitSize) + 1;
+    _isCompressed = isCompressed;
+    return true;
+}
+
+/* Reads every value into a matrix, for any form of export. Throws
+    ios_base::failure if the codes are corrupt */
+void MatrixExportReader::decode(VoteDiffMatrix& results) const
+{
+    results.assign(_memberCount, 0);
+    // Codes of the current and previous rows, for the predictions
+    vector<int> codes(_memberCount, 0);
+    vector<int> lastCodes(_memberCount, 0);
+    const unsigned char* next = _codes;
+    const unsigned char* end = _codes + _codeBytes;
+    size_t row, column;
+    for (row = 1; row < _memberCount; row++) {
+        for (column = 0; column < row; column++) {
+            int code;
+            if (!_isCompressed)
+                code = getCode(row, column);
+            else {
+                // See MatrixExport::encode() for the format
+                uint32_t folded = 0;
+                unsigned int shift = 0;
+                bool haveMore = true;
+                while (haveMore) {
+                    if ((next == end) || (shift > 28)) {
+                        results.assign(0);
+                        throwCorrupt(row);
+                    }
+                    folded |= (uint32_t)(*next & 0x7F) << shift;
+                    haveMore = (*next & 0x80) != 0;
+                    next++;
+                    shift += 7;
+                }
+                int difference = (folded & 1) ? -(int)((folded + 1) / 2) : (int)(folded / 2);
+                code = MatrixExport::predictCode(codes, lastCodes, row, column, _filteredCode) + difference;
+                codes[column] = code;
+            }
+            if ((code < 0) || (code > _filteredCode)) {
+                results.assign(0);
+                throwCorrupt(row);
+            }
+            if (_rowMembers.empty())
+                results.getRow(row)[column] = getValue(code);
+            else
+                results.set(_rowMembers[row], _rowMembers[column], getValue(code));
+        } // For each column
+        codes.swap(lastCodes);
+    } // For each row
+}
@@ -0,0 +1,194 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* These classes write difference matrices in a compact form for other programs
+    to read, such as a web server showing the results, and read them back. A
+    difference matrix held in memory uses a short per value; the differences
+    run from 0 to 1000 after normalizing, so most of those bits are wasted, and
+    a plain dump of both halves of the matrix wastes half of the rest.
+
+    The export holds only the values below the diagonal, since the matrix is
+    symmetric and the diagonal is always zero. Each value is stored as a code in
+    one of two sizes:
+    - Two bytes hold the value exactly
+    - One byte holds the value to the nearest 4, at most 2 off. That is finer
+      than the differences the clustering treats as meaningful
+    Filtered values (negative, see VoteFactory::filterLargeMismatch()) get the
+    code one past the largest value, and are read back as -1.
+
+    Optionally, the codes are compressed. Each is predicted from its neighbors
+    to the left, above, and above left, and only the difference from the
+    prediction is stored, in a variable number of bytes. The prediction only
+    works if members next to each other vote alike, so the rows can be written
+    in a given order, such as from ClusterFactory::getMemberOrder(). The order
+    is saved with the values, and reading puts the rows back. In cluster order
+    nearly every difference fits in one byte, so two byte codes shrink to the
+    size of one byte codes while keeping the exact values. One byte codes gain
+    nothing. Compressed values can only be read by decoding the whole matrix.
+
+    The export is meant to be moved between machines, so unlike the vote cache
+    it does not use the memory layout of this one. Every number is little endian.
+    The layout is a 16 byte header, the member order if any, then the codes:
+    bytes 0-3   "CRVM"
+    byte 4      format version
+    byte 5      bytes per code, 1 or 2
+    byte 6      flags; bit 0 set if the codes are compressed, bit 1 if the
+                member order follows the header
+    byte 7      difference per unit of a code, 4 or 1
+    bytes 8-11  number of members
+    bytes 12-15 number of bytes of codes
+    The member order is two bytes per member: the member each stored row holds.
+
+    The reader works on the export where it lies, such as a file mapped with
+    MappedFile, without copying the codes. Uncompressed values can be looked up
+    directly */
+#ifndef MATRIX_EXPORT_H_INCLUDED
+#define MATRIX_EXPORT_H_INCLUDED
+
+#include<string>
+#include<vector>
+#include<cstddef>
+#include<cstdint>
+#include"voteDiffMatrix.h"
+
+using std::string;
+using std::vector;
+
+class MatrixExport
+{
+public:
+    // Number of bytes per stored code
+    enum ValueSize { valueByte = 1, valueShort = 2 };
+
+    static const size_t headerSize = 16;
+
+    /* Writes the matrix in export form to the results, replacing their contents.
+        The rows are written in the given order of members, if any. Throws
+        out_of_range if any value is over 1000, or the order does not list every
+        member once */
+    static void encode(const VoteDiffMatrix& matrix, ValueSize valueSize, bool compress,
+                       vector<char>& results,
+                       const vector<unsigned short>& memberOrder = vector<unsigned short>());
+
+    /* Writes the matrix in export form to a file. Throws out_of_range as for
+        encode(), and ios_base::failure if the file can't be written */
+    static void save(const VoteDiffMatrix& matrix, const string& fileName,
+                     ValueSize valueSize, bool compress,
+                     const vector<unsigned short>& memberOrder = vector<unsigned short>());
+
+    /* Prints the size of the matrix in every export form, and what a plain dump
+        of both halves of it would take, to standard error */
+    static void debugOutputSizes(const VoteDiffMatrix& matrix,
+                                 const vector<unsigned short>& memberOrder = vector<unsigned short>());
+
+private:
+    friend class MatrixExportReader;
+
+    /* Predicts a code from the ones to its left, above, and above left, given the
+        current and previous rows of codes. Rows only hold the columns before the
+        diagonal, so the ones at the ends of a row are missing some neighbors */
+    static int predictCode(const vector<int>& codes, const vector<int>& lastCodes,
+                           size_t row, size_t column, int filteredCode);
+};
+
+class MatrixExportReader
+{
+public:
+    MatrixExportReader();
+
+    /* Checks the header of an export held in memory. The data is not copied,
+        so it must outlast the reader. Returns false if it is not a valid export */
+    bool open(const char* data, size_t size);
+
+    // Number of members; the matrix is this many rows and columns
+    size_t size(void) const;
+
+    // True if the codes are compressed
+    bool isCompressed(void) const;
+
+    /* Gets the value for a pair of members, in either order, or -1 if it was
+        filtered. Only works on uncompressed exports. Indexes are not checked */
+    short get(size_t first, size_t second) const;
+
+    /* Reads every value into a matrix, for any form of export. Throws
+        ios_base::failure if the codes are corrupt */
+    void decode(VoteDiffMatrix& results) const;
+
+private:
+    const unsigned char* _codes;
+    size_t _codeBytes;
+    size_t _memberCount;
+    unsigned int _valueSize;
+    unsigned int _unitSize; // Difference per unit of a code
+    int _filteredCode; // Code of filtered values
+    bool _isCompressed;
+    vector<unsigned short> _memberRows; // Stored row of each member. Empty if in order
+    vector<unsigned short> _rowMembers; // Member in each stored row. Empty if in order
+
+    // Converts a code back to a difference
+    short getValue(int code) const;
+
+    // Gets the code for a pair of stored rows. The first must be larger
+    int getCode(size_t row, size_t column) const;
+};
+
+inline size_t MatrixExportReader::size(void) const
+{
+    return _memberCount;
+}
+
+inline bool MatrixExportReader::isCompressed(void) const
+{
+    return _isCompressed;
+}
+
+inline short MatrixExportReader::getValue(int code) const
+{
+    if (code == _filteredCode)
+        return -1;
+    return (short)(code * _unitSize);
+}
+
+inline int MatrixExportReader::getCode(size_t row, size_t column) const
+{
+    // Rows only hold the columns before the diagonal
+    size_t index = ((row * (row - 1)) / 2) + column;
+    if (_valueSize == 1)
+        return _codes[index];
+    return _codes[2 * index] | ((int)_codes[(2 * index) + 1] << 8);
+}
+
+inline short MatrixExportReader::get(size_t first, size_t second) const
+{
+    if (!_memberRows.empty()) {
+        first = _memberRows[first];
+        second = _memberRows[second];
+    }
+    if (first == second)
+        return 0;
+    else if (first > second)
+        return getValue(getCode(first, second));
+    else
+        return getValue(getCode(second, first));
+}
+
+#endif // MATRIX_EXPORT_H_INCLUDED
@@ -0,0 +1,111 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+// Clustering with the nearest neighbor chain algorithm, under any LinkageMatrix linkage
+#include<vector>
+#include<algorithm>
+#include"nearestNeighborChain.h"
+
+using std::vector;
+
+// Orders merges by distance, breaking ties by cluster numbers
+static bool isCloserMerge(const NearestNeighborChain::Merge& first,
+                          const NearestNeighborChain::Merge& second)
+{
+    if (first._distance != second._distance)
+        return first._distance < second._distance;
+    else if (first._cluster1 != second._cluster1)
+        return first._cluster1 < second._cluster1;
+    else
+        return first._cluster2 < second._cluster2;
+}
+
+/* Finds every merge needed to combine all the Congresspeople into one cluster,
+    sorted by distance */
+void NearestNeighborChain::findMerges(const VoteDiffMatrix& distances, LinkageMatrix::Linkage linkage,
+                                      MergeList& merges)
+{
+    merges.clear();
+    unsigned short clusterCount = distances.size();
+    if (clusterCount < 2)
+        return; // Nothing to merge
+
+    /* A cluster keeps the row and column of its lowest member in the distance
+        matrix, and the rows of merged clusters are left unused. Every buffer is
+        sized up front */
+    LinkageMatrix clusterDistances(distances, linkage);
+    vector<unsigned short> activeClusters(clusterCount);
+    unsigned short clusterIndex;
+    for (clusterIndex = 0; clusterIndex < clusterCount; clusterIndex++)
+        activeClusters[clusterIndex] = clusterIndex;
+    vector<unsigned short> chain;
+    chain.reserve(clusterCount);
+    merges.reserve(clusterCount - 1);
+
+    while (activeClusters.size() > 1) {
+        if (chain.empty())
+            chain.push_back(activeClusters.front());
+        unsigned short chainEnd = chain.back();
+
+        /* Find the nearest neighbor of the cluster at the end of the chain. Ties go
+            to the lowest cluster number, which matches ordering the pairs by their
+            lower cluster and then the higher one. The active list is in order, so
+            columns of the row of the chain end come first, followed by clusters whose
+            rows hold it as a column */
+        unsigned short nearest = chainEnd;
+        double nearestDistance = 0.0;
+        const double* endRow = clusterDistances.getRow(chainEnd);
+        vector<unsigned short>::const_iterator active;
+        for (active = activeClusters.begin(); *active < chainEnd; active++)
+            if ((nearest == chainEnd) || (endRow[*active] < nearestDistance)) {
+                nearest = *active;
+                nearestDistance = endRow[*active];
+            }
+        for (active++; active != activeClusters.end(); active++) {
+            double distance = clusterDistances.getRow(*active)[chainEnd];
+            if ((nearest == chainEnd) || (distance < nearestDistance)) {
+                nearest = *active;
+                nearestDistance = distance;
+            }
+        }
+
+        if ((chain.size() < 2) || (nearest != chain[chain.size() - 2])) {
+            chain.push_back(nearest);
+            continue;
+        }
+
+        // The last two clusters in the chain are each other's nearest neighbors
+        chain.pop_back();
+        chain.pop_back();
+        Merge newMerge;
+        newMerge._cluster1 = std::min(chainEnd, nearest);
+        newMerge._cluster2 = std::max(chainEnd, nearest);
+        newMerge._distance = clusterDistances.getMergeDistance(nearestDistance);
+        merges.push_back(newMerge);
+
+        clusterDistances.merge(newMerge._cluster1, newMerge._cluster2, activeClusters);
+        activeClusters.erase(std::find(activeClusters.begin(), activeClusters.end(),
+                                       newMerge._cluster2));
+    } // While more than one cluster remains
+
+    std::sort(merges.begin(), merges.end(), isCloserMerge);
+}
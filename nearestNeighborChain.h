@@ -0,0 +1,82 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class clusters a set of Congresspeople with the nearest neighbor chain
+    algorithm. GroupDistanceMap keeps every distance sorted so the closest pair can
+    be merged next, which costs a tree node per pair and a delete and insert for
+    every distance changed by a merge. This class works on a LinkageMatrix instead,
+    a plain matrix of the distances updated in place, and never allocates memory
+    once it starts merging.
+
+    The algorithm grows a chain of clusters, each the nearest neighbor of the one
+    before it, until the last two are each other's nearest neighbors. That pair
+    would be merged by the greedy algorithm at some point no matter what else is
+    merged first, because under each linkage LinkageMatrix supports, merging other
+    clusters never brings them closer than the nearer of the parts. So the pair is
+    merged at once, and the chain continues from the cluster before them. Every
+    cluster added to the chain is eventually merged and removed, so there are at
+    most 2N nearest neighbor searches. Each visits every cluster, so the whole
+    clustering takes O(N^2) time.
+
+    The argument only holds if no two pairs are equally close, and distances tie
+    all the time since they are counts per thousand. So ties are broken by the
+    cluster numbers: the pair with the lower first cluster, then the lower second
+    one, is closer. GroupDistanceMap sorts ties the same way. Every pair then has
+    its own place in the order and, for complete linkage, both algorithms find
+    exactly the same merges.
+
+    Merges are found out of order, so they are returned sorted. Taking them in that
+    order until the distance passes a limit gives the same clusters as merging the
+    closest pair each time. Under single linkage, a merge can be listed just before
+    one at the same distance that formed one of its clusters, so apply the merges
+    by joining the clusters holding the two members named, not by cluster number */
+#ifndef NEAREST_NEIGHBOR_CHAIN_H_INCLUDED
+#define NEAREST_NEIGHBOR_CHAIN_H_INCLUDED
+
+#include<vector>
+#include"voteDiffMatrix.h"
+#include"linkageMatrix.h"
+
+using std::vector;
+
+class NearestNeighborChain
+{
+public:
+    /* One merge of two clusters. Each cluster is identified by its lowest member
+        index, which is also how ClusterFactory numbers them, so the merged cluster
+        takes the number of the first. The distance is on the scale of the vote
+        differences for every linkage */
+    struct Merge {
+        unsigned short _cluster1;
+        unsigned short _cluster2; // Always higher than the first
+        double _distance;
+    };
+    typedef vector<Merge> MergeList;
+
+    /* Finds every merge needed to combine all the Congresspeople into one cluster,
+        sorted by distance and then cluster numbers, the order the closest pair would
+        be merged each time */
+    static void findMerges(const VoteDiffMatrix& distances, LinkageMatrix::Linkage linkage,
+                           MergeList& merges);
+};
+
+#endif // NEAREST_NEIGHBOR_CHAIN_H_INCLUDED
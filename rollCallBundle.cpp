@@ -0,0 +1,185 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile also has
+    a link to the code depository)
+*/
+
+// Read files from an uncompressed tar archive in place
+#include<string>
+#include<string_view>
+#include<map>
+#include<sstream>
+#include<iostream>
+#include<cstring>
+#include"rollCallBundle.h"
+
+using std::string;
+using std::string_view;
+using std::map;
+using std::stringstream;
+using std::cerr;
+using std::endl;
+using std::ios_base;
+
+/* Layout of a tar header. Everything is in 512 byte blocks: a header, then
+    the file contents padded to a whole block. The archive ends with blocks of
+    zeros. Only the fields used here are listed */
+static const size_t tarBlockSize = 512;
+static const size_t tarNameOffset = 0;
+static const size_t tarNameSize = 100;
+static const size_t tarSizeOffset = 124;
+static const size_t tarSizeSize = 12;
+static const size_t tarChecksumOffset = 148;
+static const size_t tarChecksumSize = 8;
+static const size_t tarTypeOffset = 156;
+static const size_t tarMagicOffset = 257;
+static const size_t tarPrefixOffset = 345; // Start of the name for long paths (ustar only)
+static const size_t tarPrefixSize = 155;
+
+RollCallBundle::RollCallBundle() : _file(), _fileName(), _files()
+{
+}
+
+/* Opens an archive and indexes its files. Returns false if the archive does
+    not exist. Throws ios_base::failure if it exists but is not a valid tar file */
+bool RollCallBundle::open(const string& fileName)
+{
+    close();
+    if (!_file.open(fileName))
+        return false;
+    _fileName = fileName;
+    if (!buildIndex()) {
+        close();
+        stringstream errorText;
+        errorText << "Roll call archive " << fileName << " is not a valid tar file";
+        cerr << errorText.str() << endl;
+        throw ios_base::failure(errorText.str());
+    }
+    return true;
+}
+
+// Closes the archive. Views returned earlier are no longer valid
+void RollCallBundle::close(void)
+{
+    _files.clear();
+    _fileName.clear();
+    _file.close();
+}
+
+/* Finds the contents of a file in the archive. Returns false if the file
+    is not in the archive */
+bool RollCallBundle::find(const string& fileName, string_view& contents) const
+{
+    FileIndex::const_iterator index = _files.find(fileName);
+    if (index == _files.end())
+        return false;
+    contents = index->second;
+    return true;
+}
+
+// Converts a tar header number, stored as octal text. Returns false if invalid
+bool RollCallBundle::parseOctal(const char* text, size_t size, size_t& value)
+{
+    // The number may be padded with spaces on either side, and ends with a space or NUL
+    value = 0;
+    size_t index = 0;
+    while ((index < size) && (text[index] == ' '))
+        index++;
+    bool haveDigits = false;
+    for (; (index < size) && (text[index] >= '0') && (text[index] <= '7'); index++) {
+        value = (value * 8) + (text[index] - '0');
+        haveDigits = true;
+    }
+    for (; index < size; index++)
+        if ((text[index] != ' ') && (text[index] != '\0'))
+            return false; // Includes the binary form used for huge files, never needed here
+    return haveDigits;
+}
+
+// Reads the archive headers to build the file index. Returns false if corrupt
+bool RollCallBundle::buildIndex(void)
+{
+    const char* data = _file.getData();
+    size_t size = _file.getSize();
+    size_t offset = 0;
+    while ((offset + tarBlockSize) <= size) {
+        const char* header = data + offset;
+
+        // A block of zeros marks the end of the archive
+        size_t index;
+        for (index = 0; (index < tarBlockSize) && (header[index] == '\0'); index++);
+        if (index == tarBlockSize)
+            return true;
+
+        /* The checksum is the sum of the header bytes, with the checksum field
+            itself counted as spaces. Checking it catches files that aren't archives */
+        size_t savedChecksum, checksum = 0;
+        if (!parseOctal(header + tarChecksumOffset, tarChecksumSize, savedChecksum))
+            return false;
+        for (index = 0; index < tarBlockSize; index++)
+            if ((index >= tarChecksumOffset) && (index < (tarChecksumOffset + tarChecksumSize)))
+                checksum += ' ';
+            else
+                checksum += (unsigned char)header[index];
+        if (checksum != savedChecksum)
+            return false;
+
+        size_t fileSize;
+        if (!parseOctal(header + tarSizeOffset, tarSizeSize, fileSize))
+            return false;
+        offset += tarBlockSize;
+        if (fileSize > (size - offset))
+            return false; // Truncated archive
+
+        /* Only regular files are wanted. Old archives mark them with a NUL type.
+            Everything else (directories, links, extended headers) is skipped */
+        char fileType = header[tarTypeOffset];
+        if ((fileType == '0') || (fileType == '\0')) {
+            /* Names fill their field without a NUL when they are the maximum
+                length, so limit the search to the field */
+            string_view name(header + tarNameOffset,
+                             strnlen(header + tarNameOffset, tarNameSize));
+            string fullName;
+            if (memcmp(header + tarMagicOffset, "ustar", 5) == 0) {
+                string_view prefix(header + tarPrefixOffset,
+                                   strnlen(header + tarPrefixOffset, tarPrefixSize));
+                if (!prefix.empty()) {
+                    fullName.append(prefix);
+                    fullName.append("/");
+                }
+            }
+            fullName.append(name);
+            // Index by the name alone; where the files were archived from doesn't matter
+            size_t separator = fullName.find_last_of("/\\");
+            if (separator != string::npos)
+                fullName.erase(0, separator + 1);
+            /* If a file appears more than once, the archive was appended to and the
+                last copy is the current one */
+            if (!fullName.empty())
+                _files[fullName] = string_view(data + offset, fileSize);
+        } // Regular file
+
+        // Contents are padded to a whole block
+        offset += ((fileSize + tarBlockSize - 1) / tarBlockSize) * tarBlockSize;
+    } // Headers left in the file
+    /* Some tools omit the end blocks, or the padding after the last file, so
+        running out of data is fine. A partial header left over is not */
+    return (offset >= size);
+}
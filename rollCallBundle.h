@@ -0,0 +1,104 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class reads the files packed in an uncompressed tar archive without
+    extracting them. A session has well over a thousand roll call files, each
+    only a few kilobytes, and on network file systems opening that many files
+    takes longer than parsing them. Packing them into one archive per session
+    (tar cf rolls2011-2012.tar h2011-*.xml h2012-*.xml) means one open.
+
+    The archive is memory mapped, and its headers are read once to index every
+    file by name. Directories in stored names are ignored, so the files can be
+    archived with or without their path. File contents are returned as views
+    into the mapping, which stay valid until the archive is closed. The
+    index is never changed after opening, so any number of threads can read
+    files at once */
+#ifndef ROLL_CALL_BUNDLE_H_INCLUDED
+#define ROLL_CALL_BUNDLE_H_INCLUDED
+
+#include<map>
+#include<string>
+#include<string_view>
+#include"mappedFile.h"
+
+using std::map;
+using std::string;
+using std::string_view;
+
+class RollCallBundle
+{
+public:
+    typedef map<string, string_view> FileIndex;
+
+    RollCallBundle();
+
+    /* Opens an archive and indexes its files. Returns false if the archive does
+        not exist. Throws ios_base::failure if it exists but is not a valid tar file */
+    bool open(const string& fileName);
+
+    // Closes the archive. Views returned earlier are no longer valid
+    void close(void);
+
+    bool isOpen(void) const;
+
+    // Full path of the open archive
+    const string& getFileName(void) const;
+
+    /* Finds the contents of a file in the archive. Returns false if the file
+        is not in the archive */
+    bool find(const string& fileName, string_view& contents) const;
+
+    // Every file in the archive, indexed by name without directories
+    const FileIndex& getFiles(void) const;
+
+private:
+    MappedFile _file;
+    string _fileName;
+    FileIndex _files;
+
+    // Reads the archive headers to build the file index. Returns false if corrupt
+    bool buildIndex(void);
+
+    // Converts a tar header number, stored as octal text. Returns false if invalid
+    static bool parseOctal(const char* text, size_t size, size_t& value);
+
+    // Copying is prohibited; the mapping can't be shared
+    RollCallBundle(const RollCallBundle& other);
+    RollCallBundle& operator=(const RollCallBundle& other);
+};
+
+inline bool RollCallBundle::isOpen(void) const
+{
+    return _file.isOpen();
+}
+
+inline const string& RollCallBundle::getFileName(void) const
+{
+    return _fileName;
+}
+
+inline const RollCallBundle::FileIndex& RollCallBundle::getFiles(void) const
+{
+    return _files;
+}
+
+#endif // ROLL_CALL_BUNDLE_H_INCLUDED
@@ -0,0 +1,159 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile also has
+    a link to the code depository)
+*/
+
+// Find the roll call vote files available for a range of years
+#include<string>
+#include<vector>
+#include<map>
+#include<algorithm>
+#include<sstream>
+#include<iostream>
+#include<filesystem>
+#include<system_error>
+#include<cctype>
+#include<cstdlib>
+#include"xmlParser.h" // Defines ROLL_DIRECTORY
+#include"rollCallManifest.h"
+
+using std::string;
+using std::vector;
+using std::map;
+using std::stringstream;
+using std::cerr;
+using std::endl;
+using std::ios_base;
+
+/* Finds the roll call files for the given years, in an archive if one exists,
+    otherwise by scanning the data directory. If the last year is not given,
+    only the first is wanted. Throws ios_base::failure if the directory or
+    archive can't be read */
+RollCallManifest::RollCallManifest(short firstYear, short lastYear) : _rollCalls(), _noRollCalls(), _bundle()
+{
+    if (lastYear == 0)
+        lastYear = firstYear;
+    // SEMI-HACK: Handle this common problem
+    else if (lastYear < firstYear)
+        std::swap(firstYear, lastYear);
+    _firstYear = firstYear;
+    _lastYear = lastYear;
+
+    stringstream bundleName;
+    bundleName << ROLL_DIRECTORY << "/rolls" << _firstYear << "-" << _lastYear << ".tar";
+    if (_bundle.open(bundleName.str())) {
+        RollCallBundle::FileIndex::const_iterator fileIndex;
+        for (fileIndex = _bundle.getFiles().begin(); fileIndex != _bundle.getFiles().end(); fileIndex++)
+            addFile(fileIndex->first);
+    }
+    else
+        scanDirectory();
+
+    // Directory and archive order is whatever the tools used, so sort
+    RollCallsByYear::iterator yearIndex;
+    for (yearIndex = _rollCalls.begin(); yearIndex != _rollCalls.end(); yearIndex++)
+        std::sort(yearIndex->second.begin(), yearIndex->second.end());
+}
+
+// Adds a file to the roll calls if it is one for a wanted year
+void RollCallManifest::addFile(const string& fileName)
+{
+    short year;
+    int rollCallNo;
+    if (parseFileName(fileName, year, rollCallNo) &&
+        (year >= _firstYear) && (year <= _lastYear))
+        _rollCalls[year].push_back(rollCallNo);
+}
+
+// Finds the roll call files by scanning the data directory
+void RollCallManifest::scanDirectory(void)
+{
+    /* Use the version of the directory scan that reports errors through a code
+        instead of its own exception, so the error matches the rest of the program */
+    std::error_code error;
+    std::filesystem::directory_iterator fileIndex(ROLL_DIRECTORY, error);
+    if (error) {
+        stringstream errorText;
+        errorText << "Roll call data directory " << ROLL_DIRECTORY << " could not be read: "
+                  << error.message();
+        cerr << errorText.str() << endl;
+        throw ios_base::failure(errorText.str());
+    }
+
+    for (; fileIndex != std::filesystem::directory_iterator(); fileIndex.increment(error))
+        addFile(fileIndex->path().filename().string());
+    if (error) {
+        stringstream errorText;
+        errorText << "Roll call data directory " << ROLL_DIRECTORY << " scan failed: "
+                  << error.message();
+        cerr << errorText.str() << endl;
+        throw ios_base::failure(errorText.str());
+    }
+}
+
+// Returns the file name for a roll call, without the directory
+string RollCallManifest::getFileName(short year, int rollCallNo)
+{
+    stringstream fileName;
+    fileName << "h" << year << "-" << rollCallNo << ".xml";
+    return fileName.str();
+}
+
+// Returns the total number of roll call files found for all years
+unsigned int RollCallManifest::getRollCallCount(void) const
+{
+    unsigned int count = 0;
+    RollCallsByYear::const_iterator yearIndex;
+    for (yearIndex = _rollCalls.begin(); yearIndex != _rollCalls.end(); yearIndex++)
+        count += yearIndex->second.size();
+    return count;
+}
+
+/* Checks if a file name is a roll call file and if so extracts its year and
+    number. Returns true if the name matched. The format is h[year]-[number].xml,
+    the same one getFileName() produces */
+bool RollCallManifest::parseFileName(const string& fileName, short& year, int& rollCallNo)
+{
+    const string extension(".xml");
+    if ((fileName.size() < 8) || (fileName[0] != 'h') ||
+        (fileName.compare(fileName.size() - extension.size(), extension.size(), extension) != 0))
+        return false;
+
+    // Year is always four digits, followed by the dash
+    if (fileName[5] != '-')
+        return false;
+    unsigned short index;
+    for (index = 1; index < 5; index++)
+        if (!isdigit((unsigned char)fileName[index]))
+            return false;
+
+    // The number is everything between the dash and the extension
+    unsigned short numberEnd = fileName.size() - extension.size();
+    if (numberEnd <= 6)
+        return false; // No digits
+    for (index = 6; index < numberEnd; index++)
+        if (!isdigit((unsigned char)fileName[index]))
+            return false;
+
+    year = atoi(fileName.substr(1, 4).c_str());
+    rollCallNo = atoi(fileName.substr(6, numberEnd - 6).c_str());
+    return true;
+}
@@ -0,0 +1,124 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class lists the roll call vote files available for a range of years.
+    Roll calls are numbered from one within each year, but the numbering can
+    have gaps, and some numbers are votes that don't count (quorum calls and
+    the like). Finding the files by trying to open every number in turn
+    can't tell the end of the data from a gap. Instead, the data directory is
+    scanned once and every file name matching the roll call format is recorded.
+    The result is sorted, so the votes can be processed in order.
+
+    The files for a session can also be packed into one tar archive, named
+    rolls[first year]-[last year].tar, in the data directory. If it exists, it
+    is used instead of the separate files, and its index gives the roll calls */
+#ifndef ROLL_CALL_MANIFEST_H_INCLUDED
+#define ROLL_CALL_MANIFEST_H_INCLUDED
+
+#include<map>
+#include<vector>
+#include<string>
+#include"rollCallBundle.h"
+
+using std::map;
+using std::vector;
+using std::string;
+
+class RollCallManifest
+{
+public:
+    // Roll call numbers, in order, indexed by year
+    typedef map<short, vector<int> > RollCallsByYear;
+
+    /* Finds the roll call files for the given years, in an archive if one exists,
+        otherwise by scanning the data directory. If the last year is not given,
+        only the first is wanted. Throws ios_base::failure if the directory or
+        archive can't be read */
+    explicit RollCallManifest(short firstYear, short lastYear = 0);
+
+    short getFirstYear(void) const;
+    short getLastYear(void) const;
+
+    // Returns the roll call numbers for a year in order. Empty if none were found
+    const vector<int>& getRollCalls(short year) const;
+
+    // Returns the total number of roll call files found for all years
+    unsigned int getRollCallCount(void) const;
+
+    // Returns true if the roll calls are read from an archive instead of separate files
+    bool isBundled(void) const;
+
+    // The archive holding the roll calls. Only open if isBundled() is true
+    const RollCallBundle& getBundle(void) const;
+
+    // Returns the file name for a roll call, without the directory
+    static string getFileName(short year, int rollCallNo);
+
+private:
+    short _firstYear;
+    short _lastYear;
+    RollCallsByYear _rollCalls;
+    vector<int> _noRollCalls; // Returned for years without data
+    RollCallBundle _bundle;
+
+    // Adds a file to the roll calls if it is one for a wanted year
+    void addFile(const string& fileName);
+
+    // Finds the roll call files by scanning the data directory
+    void scanDirectory(void);
+
+    /* Checks if a file name is a roll call file and if so extracts its year and
+        number. Returns true if the name matched */
+    static bool parseFileName(const string& fileName, short& year, int& rollCallNo);
+};
+
+inline short RollCallManifest::getFirstYear(void) const
+{
+    return _firstYear;
+}
+
+inline short RollCallManifest::getLastYear(void) const
+{
+    return _lastYear;
+}
+
+// Returns the roll call numbers for a year in order. Empty if none were found
+inline const vector<int>& RollCallManifest::getRollCalls(short year) const
+{
+    RollCallsByYear::const_iterator index = _rollCalls.find(year);
+    if (index != _rollCalls.end())
+        return index->second;
+    else
+        return _noRollCalls;
+}
+
+inline bool RollCallManifest::isBundled(void) const
+{
+    return _bundle.isOpen();
+}
+
+inline const RollCallBundle& RollCallManifest::getBundle(void) const
+{
+    return _bundle;
+}
+
+#endif // ROLL_CALL_MANIFEST_H_INCLUDED
@@ -28,7 +28,9 @@
 #include<string>
 #include<cctype>
 #include<utility>
+#include"allocationCounter.h"
 #include"rollcall.h"
+#include"rollCallManifest.h"
 
 /* This objerct reads roll call results from XML files, one per roll call.
    The design is very straightforward: look for key fields as defined in the
@@ -72,17 +74,37 @@ bool RollCall::open(short year, int rollCallNo)
 {
     // Clear processing data from previous file, if any
     clearVoteData();
-    /* The roll call file name has the following format: h-yyyy-xxxx.
-    NOTE: The code below is the 'official' way of forming file names in
-    C++. It's clunky enough that many just do a sprintf into a formatted C style
-    string. The code below has more formatting flexibility however
-    NOTE: Remember to include the file extension in the name, even though
-    most people don't see it in Windows! */
-  stringstream fileName;
-  fileName << "h" << year << "-" << rollCallNo << ".xml";
-  XmlParser::open(fileName.str());
-  if (!isOpen())
-    cerr << "Could not find roll call " << rollCallNo << " for year " << year << "." << endl;
+  // The roll call file name has the following format: h-yyyy-xxxx.xml
+  XmlParser::open(RollCallManifest::getFileName(year, rollCallNo));
+  return validateFile(year, rollCallNo);
+}
+
+/* Opens a roll call vote from wherever the manifest found it, a separate file
+   or an archive, and validates it. Returns true if successful */
+bool RollCall::open(const RollCallManifest& rollCalls, short year, int rollCallNo)
+{
+  if (!rollCalls.isBundled())
+    return open(year, rollCallNo);
+
+  clearVoteData();
+  close(); // A roll call missing from the archive must not leave the last one open
+  string_view contents;
+  if (rollCalls.getBundle().find(RollCallManifest::getFileName(year, rollCallNo), contents))
+    openText(contents);
+  return validateFile(year, rollCallNo);
+}
+
+/* Checks that a newly opened roll call is an up or down vote, and reads the
+   first vote. Returns true if it has votes */
+bool RollCall::validateFile(short year, int rollCallNo)
+{
+  /* NOTE: Messages are formatted first and written in one piece, so they stay
+    readable when several threads are reading roll calls at once */
+  if (!isOpen()) {
+    stringstream message;
+    message << "Could not find roll call " << rollCallNo << " for year " << year << "." << endl;
+    cerr << message.str();
+  }
   else {
     // Validate the file
     /* Roll call votes are recorded using particular words, which vary
@@ -105,7 +127,7 @@ bool RollCall::open(short year, int rollCallNo)
             indicatees there will not be other types of votes in the same file. At
             the time this was written, it was true by definition because each file
             contains one and only one roll call vote */
-        string value(getText(3));
+        string_view value(getTextView(3));
         /* The format of all fields is [key]="[vakye]". All the wanted fields are single
             chars, so test for the quotes to detect a longer value */
         if (value.length() == 3) {
@@ -121,12 +143,14 @@ bool RollCall::open(short year, int rollCallNo)
     if (!rightVotes) {
         /* Either did not find the vote type key field, or the vote is the wrong type
             Close file and reject */
-        cerr << "Roll Call Vote " << rollCallNo << " rejected. ";
+        stringstream message;
+        message << "Roll Call Vote " << rollCallNo << " rejected. ";
         if (!haveEOF())
-            cerr << "Not an up or down vote";
+            message << "Not an up or down vote";
         else
-            cerr << "No Vote Data";
-        cerr << endl;
+            message << "No Vote Data";
+        message << endl;
+        cerr << message.str();
         close(); // Close after message so EOF test works properly
    }
     else
@@ -161,6 +185,8 @@ void RollCall::loadNextVote(void)
 
     /* Certain votes in the file are not considered vote results, so need to burn
         them when found */
+    /* NOTE: This runs for every voter in every file, so it uses the view versions
+        of the text methods. Nothing in the loop allocates memory */
 
     while ((!_haveVotes) && haveTextToProcess()) {
         burnToKey(_voterId);
@@ -169,7 +195,7 @@ void RollCall::loadNextVote(void)
             burnToKey(_vote, false); // If this key is not on same line as previous, bad input
             if (!haveLineEnd()) { // Found something
                 burnChars(1); // Eliminate the '"'
-                string voteChar(getTextToToken('"'));
+                string_view voteChar(getTextViewToToken('"'));
                 if (voteChar.length() == 1) {
                     // Data is right size
                     if ((voteChar[0] == '+') ||
@@ -188,3 +214,25 @@ void RollCall::loadNextVote(void)
     return;
 }
 
+/* Reads every vote in a roll call file and reports the number of heap
+    allocations made doing it, which should be zero. Opening the file is not
+    counted. Results are written to standard error */
+void RollCall::debugCountAllocations(short year, int rollCallNo)
+{
+    if (!AllocationCounter::isEnabled()) {
+        cerr << "Allocation counting not compiled in, define COUNT_ALLOCATIONS" << endl;
+        return;
+    }
+    RollCall rollCall;
+    if (!rollCall.open(year, rollCallNo))
+        return;
+    unsigned long startCount = AllocationCounter::getCount();
+    unsigned int voteCount = 0;
+    while (rollCall.haveVotes()) {
+        rollCall.getNextVote();
+        voteCount++;
+    }
+    unsigned long allocationCount = AllocationCounter::getCount() - startCount;
+    cerr << "Roll call " << rollCallNo << " for year " << year << ": " << voteCount
+         << " votes read with " << allocationCount << " heap allocations" << endl;
+}
@@ -37,6 +37,9 @@ using std::fstream;
 // NOTE: The header is NOT listed above, since it is used in many source files (and they should include it)
 using std::pair;
 
+// Only used by reference, so callers that don't need it don't need the header
+class RollCallManifest;
+
 class RollCall : public XmlParser {
 public:
   /* A single vote from the file. Note that abstentions and the like
@@ -61,6 +64,10 @@ private:
   // Finds the next vote in the file. Sets _haveVotes based on the result
   void loadNextVote(void);
 
+  /* Checks that a newly opened roll call is an up or down vote, and reads the
+     first vote. Returns true if it has votes */
+  bool validateFile(short year, int rollCallNo);
+
   /* Assignment operator and copy constructor. The parser can't be copied
      (this requires the ability to open the same file twice, which is
      controlled by the operating system) so these are private */
@@ -75,10 +82,19 @@ public:
   // Opens a roll call vote and validate the file. Returns true if successful
   bool open(short year, int rollCallNo);
 
+  /* Opens a roll call vote from wherever the manifest found it, a separate file
+     or an archive, and validates it. Returns true if successful */
+  bool open(const RollCallManifest& rollCalls, short year, int rollCallNo);
+
   // Returns true if more votes remain to read from the file
   inline bool haveVotes() { return _haveVotes; }
 
   // Returns the next vote from the file
   // NOTE: Can't be a reference due to the prefetch!
   VoteRecord getNextVote(void);
+
+  /* Reads every vote in a roll call file and reports the number of heap
+     allocations made doing it, which should be zero. Only works if the
+     program was built with COUNT_ALLOCATIONS defined */
+  static void debugCountAllocations(short year, int rollCallNo);
 };
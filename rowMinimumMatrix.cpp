@@ -0,0 +1,278 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+// Closest pair search for complete linkage from the lowest distance of each row
+#include<vector>
+#include<string>
+#include<iostream>
+#include<chrono>
+#include<limits>
+#include<algorithm>
+#include"cpuFeatures.h"
+#include"rowMinimumMatrix.h"
+
+#ifdef HAVE_X86_SIMD
+#include<immintrin.h>
+#endif
+
+using std::vector;
+using std::string;
+using std::cerr;
+using std::endl;
+
+const short RowMinimumMatrix::mergedDistance = std::numeric_limits<short>::max();
+
+// Key of a row with no clusters left to merge with
+static const uint32_t noRowKey = std::numeric_limits<uint32_t>::max();
+
+// Sets up one cluster per member, with the distances between members
+RowMinimumMatrix::RowMinimumMatrix(const VoteDiffMatrix& distances)
+    : _distances(), _rowKeys(distances.size(), noRowKey)
+{
+    unsigned short clusterCount = distances.size();
+    if (clusterCount < 2)
+        return;
+    _distances.reserve(getRowOffset(clusterCount));
+    unsigned short row;
+    for (row = 1; row < clusterCount; row++) {
+        const short* distanceRow = distances.getRow(row);
+        _distances.insert(_distances.end(), distanceRow, distanceRow + row);
+        updateRowKey(row);
+    }
+}
+
+// Finds the lowest distance in a row again, and stores it
+void RowMinimumMatrix::updateRowKey(unsigned short row)
+{
+    if (row == 0) // No columns
+        return;
+    const short* distanceRow = _distances.data() + getRowOffset(row);
+    unsigned short column = getMinimumMethod()(distanceRow, row);
+    if (distanceRow[column] == mergedDistance)
+        _rowKeys[row] = noRowKey;
+    else
+        _rowKeys[row] = ((uint32_t)distanceRow[column] << 16) | column;
+}
+
+/* Finds the closest pair of clusters, the lower numbered first. Returns false if
+    fewer than two clusters are left */
+bool RowMinimumMatrix::findClosestPair(unsigned short& cluster1, unsigned short& cluster2,
+                                       short& distance) const
+{
+    // The first row with the lowest key wins ties on the column, so it is the closest pair
+    vector<uint32_t>::const_iterator closest = std::min_element(_rowKeys.begin(), _rowKeys.end());
+    if ((closest == _rowKeys.end()) || (*closest == noRowKey))
+        return false;
+    cluster1 = (unsigned short)(*closest & 0xFFFF);
+    cluster2 = (unsigned short)(closest - _rowKeys.begin());
+    distance = (short)(*closest >> 16);
+    return true;
+}
+
+/* Merges the second cluster into the first using complete linkage. Either may be
+    the lower numbered */
+void RowMinimumMatrix::merge(unsigned short keptCluster, unsigned short mergedCluster)
+{
+    unsigned short lowCluster = std::min(keptCluster, mergedCluster);
+    unsigned short highCluster = std::max(keptCluster, mergedCluster);
+    short* lowRow = _distances.data() + getRowOffset(lowCluster);
+    short* highRow = _distances.data() + getRowOffset(highCluster);
+    size_t rowCount = size();
+    size_t index;
+
+    /* The new distance to each other cluster is the larger of the two. Merged clusters
+        are already at the highest distance, so they stay there. Where the pair is
+        depends on the other cluster: below both, it is a column of both rows; between
+        them, a column of the high row and a row of its own; above both, two columns
+        of its row */
+    short* keptRow = (keptCluster == lowCluster) ? lowRow : highRow;
+    short* mergedRow = (keptCluster == lowCluster) ? highRow : lowRow;
+    for (index = 0; index < lowCluster; index++) {
+        keptRow[index] = std::max(keptRow[index], mergedRow[index]);
+        mergedRow[index] = mergedDistance;
+    }
+    for (index = lowCluster + 1; index < highCluster; index++) {
+        short& lowDistance = _distances[getRowOffset(index) + lowCluster];
+        short& highDistance = highRow[index];
+        short& keptDistance = (keptCluster == lowCluster) ? lowDistance : highDistance;
+        short& removedDistance = (keptCluster == lowCluster) ? highDistance : lowDistance;
+        keptDistance = std::max(lowDistance, highDistance);
+        removedDistance = mergedDistance;
+    }
+    for (index = highCluster + 1; index < rowCount; index++) {
+        short* otherRow = _distances.data() + getRowOffset(index);
+        otherRow[keptCluster] = std::max(otherRow[lowCluster], otherRow[highCluster]);
+        otherRow[mergedCluster] = mergedDistance;
+    }
+    highRow[lowCluster] = mergedDistance;
+
+    /* Distances only rise, so a row minimum is still right unless it was in one of
+        the two columns. The kept row changed throughout */
+    _rowKeys[mergedCluster] = noRowKey;
+    updateRowKey(keptCluster);
+    for (index = lowCluster + 1; index < rowCount; index++) {
+        if ((index == keptCluster) || (_rowKeys[index] == noRowKey))
+            continue;
+        unsigned short keyColumn = (unsigned short)(_rowKeys[index] & 0xFFFF);
+        if ((keyColumn == lowCluster) || (keyColumn == highCluster))
+            updateRowKey(index);
+    }
+}
+
+// Plain C++ version
+unsigned short RowMinimumMatrix::findMinimumScalar(const short* values, unsigned short count)
+{
+    unsigned short lowestIndex = 0;
+    unsigned short index;
+    for (index = 1; index < count; index++)
+        if (values[index] < values[lowestIndex])
+            lowestIndex = index;
+    return lowestIndex;
+}
+
+#ifdef HAVE_X86_SIMD
+
+/* The vector versions find the lowest value first, keeping a running minimum in
+    each lane, then search for the first place it occurs. The second pass usually
+    stops long before the end of the row */
+
+unsigned short TARGET_SSE2 RowMinimumMatrix::findMinimumSse2(const short* values, unsigned short count)
+{
+    short lowest = mergedDistance;
+    unsigned short index = 0;
+    if (count >= 8) {
+        __m128i lowestBlock = _mm_loadu_si128((const __m128i*)values);
+        for (index = 8; index + 8 <= count; index += 8)
+            lowestBlock = _mm_min_epi16(lowestBlock, _mm_loadu_si128((const __m128i*)(values + index)));
+        lowestBlock = _mm_min_epi16(lowestBlock, _mm_shuffle_epi32(lowestBlock, _MM_SHUFFLE(1, 0, 3, 2)));
+        lowestBlock = _mm_min_epi16(lowestBlock, _mm_shuffle_epi32(lowestBlock, _MM_SHUFFLE(2, 3, 0, 1)));
+        lowestBlock = _mm_min_epi16(lowestBlock, _mm_shufflelo_epi16(lowestBlock, _MM_SHUFFLE(2, 3, 0, 1)));
+        lowest = (short)_mm_cvtsi128_si32(lowestBlock);
+    }
+    for (; index < count; index++)
+        lowest = std::min(lowest, values[index]);
+
+    const __m128i target = _mm_set1_epi16(lowest);
+    for (index = 0; index + 8 <= count; index += 8) {
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(
+            _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(values + index)), target));
+        if (mask)
+            return index + (lowestSetBit(mask) / 2);
+    }
+    while (values[index] != lowest)
+        index++;
+    return index;
+}
+
+unsigned short TARGET_AVX2 RowMinimumMatrix::findMinimumAvx2(const short* values, unsigned short count)
+{
+    short lowest = mergedDistance;
+    unsigned short index = 0;
+    if (count >= 16) {
+        __m256i lowestBlock = _mm256_loadu_si256((const __m256i*)values);
+        for (index = 16; index + 16 <= count; index += 16)
+            lowestBlock = _mm256_min_epi16(lowestBlock, _mm256_loadu_si256((const __m256i*)(values + index)));
+        __m128i lowestHalf = _mm_min_epi16(_mm256_castsi256_si128(lowestBlock),
+                                           _mm256_extracti128_si256(lowestBlock, 1));
+        lowestHalf = _mm_min_epi16(lowestHalf, _mm_shuffle_epi32(lowestHalf, _MM_SHUFFLE(1, 0, 3, 2)));
+        lowestHalf = _mm_min_epi16(lowestHalf, _mm_shuffle_epi32(lowestHalf, _MM_SHUFFLE(2, 3, 0, 1)));
+        lowestHalf = _mm_min_epi16(lowestHalf, _mm_shufflelo_epi16(lowestHalf, _MM_SHUFFLE(2, 3, 0, 1)));
+        lowest = (short)_mm_cvtsi128_si32(lowestHalf);
+    }
+    for (; index < count; index++)
+        lowest = std::min(lowest, values[index]);
+
+    const __m256i target = _mm256_set1_epi16(lowest);
+    for (index = 0; index + 16 <= count; index += 16) {
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*)(values + index)), target));
+        if (mask)
+            return index + (lowestSetBit(mask) / 2);
+    }
+    while (values[index] != lowest)
+        index++;
+    return index;
+}
+
+#endif // HAVE_X86_SIMD
+
+// Picks the routine. Called once, by getMinimumMethod()
+RowMinimumMatrix::MinimumMethod RowMinimumMatrix::selectMinimumMethod(void)
+{
+#ifdef HAVE_X86_SIMD
+    if (CpuFeatures::haveAvx2())
+        return &findMinimumAvx2;
+    else if (CpuFeatures::haveSse2())
+        return &findMinimumSse2;
+#endif
+    return &findMinimumScalar;
+}
+
+// Returns the best search routine for this processor. Chosen once
+RowMinimumMatrix::MinimumMethod RowMinimumMatrix::getMinimumMethod(void)
+{
+    static const MinimumMethod method = selectMinimumMethod();
+    return method;
+}
+
+/* Times every row search version available on this processor on rows of the
+    given length. Results are written to standard error */
+void RowMinimumMatrix::debugBenchmark(unsigned short rowLength, unsigned int iterations)
+{
+    if (rowLength < 1)
+        rowLength = 1;
+    // Distances shaped like vote differences, with the lowest late in the row
+    vector<short> row(rowLength);
+    unsigned short index;
+    for (index = 0; index < rowLength; index++)
+        row[index] = (short)(100 + (((index * 2654435761u) >> 12) % 900));
+    row[(rowLength * 7) / 8] = 50;
+
+    vector<std::pair<string, MinimumMethod> > methods;
+    methods.push_back(std::make_pair(string("scalar"), &findMinimumScalar));
+#ifdef HAVE_X86_SIMD
+    if (CpuFeatures::haveSse2())
+        methods.push_back(std::make_pair(string("SSE2"), &findMinimumSse2));
+    if (CpuFeatures::haveAvx2())
+        methods.push_back(std::make_pair(string("AVX2"), &findMinimumAvx2));
+#endif
+
+    typedef std::chrono::steady_clock Clock;
+    double scalarTime = 0.0;
+    vector<std::pair<string, MinimumMethod> >::const_iterator method;
+    for (method = methods.begin(); method != methods.end(); method++) {
+        /* Sum the found positions so the compiler can't discard the searches. The
+            sums also double as a check that every method finds the same thing */
+        unsigned long total = 0;
+        Clock::time_point start = Clock::now();
+        unsigned int pass;
+        for (pass = 0; pass < iterations; pass++)
+            total += method->second(row.data(), rowLength);
+        double time = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+        if (method == methods.begin())
+            scalarTime = time;
+        cerr << method->first << ": " << time << " ns per row of " << rowLength;
+        if (method != methods.begin())
+            cerr << ", " << (scalarTime / time) << "x scalar";
+        cerr << " (check " << total << ")" << endl;
+    }
+}
@@ -0,0 +1,117 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class finds the closest pair of clusters for complete linkage clustering
+    from a plain matrix of the distances, instead of keeping every distance sorted
+    the way GroupDistanceMap does. Each row keeps its lowest distance and the
+    column it is in. The closest pair overall is then the lowest of the row
+    minimums, found with one pass over them.
+
+    A merge raises the distances of the kept cluster to the larger of the two, and
+    marks the merged cluster's row and column with a distance too high to ever be
+    merged. Complete linkage distances never fall, so a row minimum only has to be
+    found again if it was in one of the two columns merged. Doing so is a minimum
+    over a row of 16 bit distances, which vector instructions handle 8 or 16 at a
+    time. Versions exist for AVX2, SSE2, and plain C++; the best one the processor
+    supports is chosen the first time a row is searched.
+
+    Ties are broken the same way as GroupDistanceMap: the pair with the lower first
+    cluster, then the lower second cluster, is closer. So both find exactly the
+    same merges. The distances are packed like VoteDiffMatrix but without the
+    diagonal, two bytes per pair, where GroupDistanceMap needs a tree node and an
+    iterator per pair. This lets it cluster far larger sets of members */
+#ifndef ROW_MINIMUM_MATRIX_H_INCLUDED
+#define ROW_MINIMUM_MATRIX_H_INCLUDED
+
+#include<vector>
+#include<cstddef>
+#include<cstdint>
+#include"cpuFeatures.h" // Defines HAVE_X86_SIMD
+#include"voteDiffMatrix.h"
+
+using std::vector;
+
+class RowMinimumMatrix
+{
+public:
+    // Sets up one cluster per member, with the distances between members
+    explicit RowMinimumMatrix(const VoteDiffMatrix& distances);
+
+    // Number of clusters the matrix started with
+    size_t size(void) const;
+
+    /* Finds the closest pair of clusters, the lower numbered first. Returns false if
+        fewer than two clusters are left */
+    bool findClosestPair(unsigned short& cluster1, unsigned short& cluster2, short& distance) const;
+
+    /* Merges the second cluster into the first using complete linkage. Either may be
+        the lower numbered. The second is never returned as part of a pair again */
+    void merge(unsigned short keptCluster, unsigned short mergedCluster);
+
+    /* Times every row search version available on this processor on rows of the
+        given length. Results are written to standard error */
+    static void debugBenchmark(unsigned short rowLength = 5000, unsigned int iterations = 20000);
+
+private:
+    // Finds the index of the first lowest value. The count must not be zero
+    typedef unsigned short (*MinimumMethod)(const short* values, unsigned short count);
+
+    /* Distance for the row and column of a merged cluster. It sorts after every
+        real distance, so the searches need no separate list of live clusters */
+    static const short mergedDistance;
+
+    vector<short> _distances;
+    /* Lowest distance of each row in the upper half and its column in the lower,
+        so comparing two keys compares the distances, then the columns */
+    vector<uint32_t> _rowKeys;
+
+    // Location of the first value of a row
+    static size_t getRowOffset(size_t row);
+
+    // Finds the lowest distance in a row again, and stores it
+    void updateRowKey(unsigned short row);
+
+    // The search routines
+    static unsigned short findMinimumScalar(const short* values, unsigned short count);
+#ifdef HAVE_X86_SIMD
+    static unsigned short findMinimumSse2(const short* values, unsigned short count);
+    static unsigned short findMinimumAvx2(const short* values, unsigned short count);
+#endif
+
+    // Returns the best search routine for this processor. Chosen once
+    static MinimumMethod getMinimumMethod(void);
+
+    // Picks the routine. Called once, by getMinimumMethod()
+    static MinimumMethod selectMinimumMethod(void);
+};
+
+inline size_t RowMinimumMatrix::getRowOffset(size_t row)
+{
+    return (row * (row - 1)) / 2;
+}
+
+inline size_t RowMinimumMatrix::size(void) const
+{
+    return _rowKeys.size();
+}
+
+#endif // ROW_MINIMUM_MATRIX_H_INCLUDED
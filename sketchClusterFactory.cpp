@@ -0,0 +1,584 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+// Approximate complete linkage clustering for very large sets of Congresspeople
+#include<iostream>
+#include<vector>
+#include<map>
+#include<queue>
+#include<algorithm>
+#include<functional>
+#include<limits>
+#include<chrono>
+#include"congressData.h"
+#include"regionMapper.h"
+#include"voteFactory.h"
+#include"voteDiffCounter.h"
+#include"clusterFactory.h"
+#include"dendrogram.h"
+#include"sketchClusterFactory.h"
+
+using std::cerr;
+using std::endl;
+using std::vector;
+using std::map;
+using std::pair;
+
+// Sketch value of a bin no vote fell into
+static const uint32_t emptySketchValue = std::numeric_limits<uint32_t>::max();
+
+/* Scrambles a value so every bit of the result depends on every bit of the input.
+    This is the finalizer of the SplitMix64 generator */
+static inline uint64_t mixBits(uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+/* Exact differences between members, counted from the vote bits when asked for. A
+    member's votes only cover the sessions they served, so each pair only compares
+    the words of roll calls from the later first vote to the earlier last one. The
+    results are the same as VoteFactory gives for the metric */
+class MemberDifferences
+{
+public:
+    MemberDifferences(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                      VoteFactory::DiffMetric metric);
+
+    short get(unsigned short first, unsigned short second) const;
+
+private:
+    const VoteBitMatrix& _passVotes;
+    const VoteBitMatrix& _voted;
+    VoteFactory::DiffMetric _metric;
+    vector<unsigned int> _firstWords; // First word with a vote
+    vector<unsigned int> _endWords; // Word after the last with a vote
+    vector<int> _voteCounts; // Only used by Jaccard
+};
+
+MemberDifferences::MemberDifferences(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                                     VoteFactory::DiffMetric metric)
+    : _passVotes(passVotes), _voted(voted), _metric(metric),
+      _firstWords(voted.getMemberCount(), 0), _endWords(voted.getMemberCount(), 0), _voteCounts()
+{
+    unsigned int wordCount = voted.getWordsPerRow();
+    unsigned short member;
+    for (member = 0; member < voted.getMemberCount(); member++) {
+        const VoteBitMatrix::Word* row = voted.getRow(member);
+        unsigned int first = 0, end = wordCount;
+        while ((first < wordCount) && (row[first] == 0))
+            first++;
+        while ((end > first) && (row[end - 1] == 0))
+            end--;
+        _firstWords[member] = first;
+        _endWords[member] = end;
+    }
+    if (_metric == VoteFactory::metricJaccard)
+        for (member = 0; member < voted.getMemberCount(); member++)
+            _voteCounts.push_back(voted.countRow(member));
+}
+
+short MemberDifferences::get(unsigned short first, unsigned short second) const
+{
+    if (first == second)
+        return 0;
+    unsigned int firstWord = std::max(_firstWords[first], _firstWords[second]);
+    unsigned int endWord = std::min(_endWords[first], _endWords[second]);
+    unsigned int sameVotes = 0, bothVoted = 0;
+    if (firstWord < endWord)
+        VoteDiffCounter::countPair(_passVotes, _voted, first, second, firstWord, endWord - firstWord,
+                                   sameVotes, bothVoted);
+
+    // Same arithmetic as VoteFactory::normalizeCounts()
+    if (_metric == VoteFactory::metricDisagreement) {
+        int billCount = _voted.getRollCallCount();
+        if (billCount <= 0)
+            return 0;
+        return (short)(((billCount - (int)sameVotes) * 1000) / billCount);
+    }
+    int total;
+    if (_metric == VoteFactory::metricAbsenceCorrected)
+        total = bothVoted;
+    else
+        total = _voteCounts[first] + _voteCounts[second] - (int)sameVotes;
+    if (total > 0)
+        return (short)(((total - (int)sameVotes) * 1000) / total);
+    else
+        return 1000;
+}
+
+/* Finds the complete linkage difference between two clusters: the largest between
+    any of their members. Stops as soon as it passes the limit, since the pair can't
+    be merged then anyway, and returns the difference found so far */
+static short findClusterDifference(const MemberDifferences& differences, const CongressGroup& cluster1,
+                                   const CongressGroup& cluster2, short limit)
+{
+    vector<unsigned short> members1, members2;
+    cluster1.getMembers(members1);
+    cluster2.getMembers(members2);
+    short largest = 0;
+    vector<unsigned short>::const_iterator member1, member2;
+    for (member1 = members1.begin(); member1 != members1.end(); member1++)
+        for (member2 = members2.begin(); member2 != members2.end(); member2++) {
+            largest = std::max(largest, differences.get(*member1, *member2));
+            if (largest > limit)
+                return largest;
+        }
+    return largest;
+}
+
+/* A pair of clusters that may be merged, and the difference between them when it
+    was found. Each cluster's merge count is stored too; if either has merged since,
+    the difference is out of date. Ordered the same as GroupDistanceMap, by the
+    difference, then the lower cluster, then the higher */
+struct MergeCandidate
+{
+    short _difference;
+    unsigned short _cluster1; // The lower
+    unsigned short _cluster2;
+    unsigned int _mergeCount1;
+    unsigned int _mergeCount2;
+
+    bool operator>(const MergeCandidate& other) const
+    {
+        if (_difference != other._difference)
+            return _difference > other._difference;
+        if (_cluster1 != other._cluster1)
+            return _cluster1 > other._cluster1;
+        return _cluster2 > other._cluster2;
+    }
+};
+
+/* Given the vote bits of the Congresspeople and the level of vote differences
+    considered to be noise, returns the groups of Congresspeople */
+void SketchClusterFactory::formClusters(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                                        CongressGroupVector& congressMatchGroups,
+                                        short noiseThreshold, short minGroups,
+                                        VoteFactory::DiffMetric metric, unsigned short sketchRollCalls,
+                                        unsigned short bandCount, unsigned short valuesPerBand,
+                                        unsigned short bucketPairLimit)
+{
+    congressMatchGroups.clear();
+    // SANITY CHECK
+    unsigned short memberCount = voted.getMemberCount();
+    if ((memberCount == 0) || (passVotes.getMemberCount() != memberCount) ||
+            (passVotes.getRollCallCount() != voted.getRollCallCount())) {
+        cerr << "Grouping failed, vote bits are empty or do not match!" << endl;
+        return;
+    }
+    if (minGroups < 1)
+        minGroups = 1; // Ensure merge loop terminates
+    if (bandCount < 1)
+        bandCount = 1;
+    if (valuesPerBand < 1)
+        valuesPerBand = 1;
+    if (bucketPairLimit < 1)
+        bucketPairLimit = 1;
+    unsigned int periodWords = std::max(1u, ((unsigned int)sketchRollCalls + VoteBitMatrix::bitsPerWord - 1) /
+                                                VoteBitMatrix::bitsPerWord);
+
+    vector<SketchValue> sketches;
+    vector<SketchOwner> owners;
+    findSketches(passVotes, voted, periodWords, bandCount * valuesPerBand, sketches, owners);
+    vector<uint32_t> candidates;
+    findCandidatePairs(sketches, owners, bandCount, valuesPerBand, bucketPairLimit, candidates);
+    sketches.clear();
+    sketches.shrink_to_fit();
+
+    unsigned short member;
+    congressMatchGroups.resize(memberCount);
+    for (member = 0; member < memberCount; member++)
+        congressMatchGroups[member].insert(member);
+    vector<unsigned int> mergeCounts(memberCount, 0);
+
+    /* The differences known between each cluster and the others, those too far apart
+        to merge included, so they are never counted again. The candidates start it */
+    MemberDifferences differences(passVotes, voted, metric);
+    vector<map<unsigned short, short> > neighbors(memberCount);
+    std::priority_queue<MergeCandidate, vector<MergeCandidate>, std::greater<MergeCandidate> > mergeQueue;
+    vector<uint32_t>::const_iterator candidate;
+    for (candidate = candidates.begin(); candidate != candidates.end(); candidate++) {
+        MergeCandidate newCandidate;
+        newCandidate._cluster1 = (unsigned short)(*candidate >> 16);
+        newCandidate._cluster2 = (unsigned short)(*candidate & 0xFFFF);
+        newCandidate._difference = differences.get(newCandidate._cluster1, newCandidate._cluster2);
+        newCandidate._mergeCount1 = newCandidate._mergeCount2 = 0;
+        neighbors[newCandidate._cluster1][newCandidate._cluster2] = newCandidate._difference;
+        neighbors[newCandidate._cluster2][newCandidate._cluster1] = newCandidate._difference;
+        if (newCandidate._difference <= noiseThreshold)
+            mergeQueue.push(newCandidate);
+    }
+    candidates.clear();
+    candidates.shrink_to_fit();
+
+    /* Each entry in the queue was exact when added. A merge makes the entries of both
+        clusters out of date, and adds new ones for the merged cluster, so an entry for
+        a cluster that has merged since is skipped. The first entry still up to date is
+        the closest pair */
+    unsigned short clusterCount = memberCount;
+    while ((clusterCount > minGroups) && !mergeQueue.empty()) {
+        MergeCandidate next = mergeQueue.top();
+        mergeQueue.pop();
+        if ((congressMatchGroups[next._cluster1].empty()) || (congressMatchGroups[next._cluster2].empty()) ||
+                (mergeCounts[next._cluster1] != next._mergeCount1) ||
+                (mergeCounts[next._cluster2] != next._mergeCount2))
+            continue;
+
+        unsigned short keptCluster = next._cluster1, mergedCluster = next._cluster2;
+
+        /* The merged cluster is as far from each neighbor as the further of its parts.
+            Where only one part was compared with a neighbor, the other is compared member
+            by member, unless the first is already too far for the pair to ever merge */
+        map<unsigned short, short>& keptNeighbors = neighbors[keptCluster];
+        map<unsigned short, short>& mergedNeighbors = neighbors[mergedCluster];
+        keptNeighbors.erase(mergedCluster);
+        mergedNeighbors.erase(keptCluster);
+        map<unsigned short, short>::iterator neighbor;
+        for (neighbor = keptNeighbors.begin(); neighbor != keptNeighbors.end(); neighbor++)
+            if ((neighbor->second <= noiseThreshold) &&
+                    (mergedNeighbors.find(neighbor->first) == mergedNeighbors.end()))
+                neighbor->second = std::max(neighbor->second,
+                    findClusterDifference(differences, congressMatchGroups[mergedCluster],
+                                          congressMatchGroups[neighbor->first], noiseThreshold));
+        for (neighbor = mergedNeighbors.begin(); neighbor != mergedNeighbors.end(); neighbor++) {
+            neighbors[neighbor->first].erase(mergedCluster);
+            map<unsigned short, short>::iterator keptNeighbor = keptNeighbors.find(neighbor->first);
+            if (keptNeighbor != keptNeighbors.end())
+                keptNeighbor->second = std::max(keptNeighbor->second, neighbor->second);
+            else if (neighbor->second > noiseThreshold)
+                keptNeighbors[neighbor->first] = neighbor->second;
+            else
+                keptNeighbors[neighbor->first] = std::max(neighbor->second,
+                    findClusterDifference(differences, congressMatchGroups[keptCluster],
+                                          congressMatchGroups[neighbor->first], noiseThreshold));
+        }
+        mergedNeighbors.clear();
+
+        congressMatchGroups[keptCluster].unite(congressMatchGroups[mergedCluster]);
+        congressMatchGroups[mergedCluster].clear();
+        mergeCounts[keptCluster]++;
+        clusterCount--;
+
+        // Queue the merged cluster with every neighbor still close enough
+        for (neighbor = keptNeighbors.begin(); neighbor != keptNeighbors.end(); neighbor++) {
+            neighbors[neighbor->first][keptCluster] = neighbor->second;
+            if (neighbor->second > noiseThreshold)
+                continue;
+            MergeCandidate newCandidate;
+            newCandidate._difference = neighbor->second;
+            newCandidate._cluster1 = std::min(keptCluster, neighbor->first);
+            newCandidate._cluster2 = std::max(keptCluster, neighbor->first);
+            newCandidate._mergeCount1 = mergeCounts[newCandidate._cluster1];
+            newCandidate._mergeCount2 = mergeCounts[newCandidate._cluster2];
+            mergeQueue.push(newCandidate);
+        }
+    } // while clusters to merge
+    ClusterFactory::removeEmptyGroups(congressMatchGroups);
+}
+
+/* Finds the sketches of each member's votes in each period they voted enough in.
+    Hashing each vote once and keeping the lowest hash in each of the bins gives the
+    same chance of two members matching in a bin as a separate hash per value, for a
+    fraction of the work. A bin no vote fell into takes the value of the next one that
+    has one, changed by the distance, so members with few votes still match fairly */
+void SketchClusterFactory::findSketches(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                                        unsigned int periodWords, unsigned short valueCount,
+                                        vector<SketchValue>& sketches, vector<SketchOwner>& owners)
+{
+    // Too few votes make a sketch that matches by chance
+    const unsigned int minSketchVotes = 16;
+    unsigned short memberCount = voted.getMemberCount();
+    unsigned int wordCount = voted.getWordsPerRow();
+    sketches.clear();
+    owners.clear();
+    vector<SketchValue> sketch(valueCount), found(valueCount);
+    unsigned short member;
+    for (member = 0; member < memberCount; member++) {
+        const VoteBitMatrix::Word* votedRow = voted.getRow(member);
+        const VoteBitMatrix::Word* passRow = passVotes.getRow(member);
+        unsigned int periodStart;
+        for (periodStart = 0; periodStart < wordCount; periodStart += periodWords) {
+            unsigned int periodEnd = std::min(periodStart + periodWords, wordCount);
+            sketch.assign(valueCount, emptySketchValue);
+            unsigned int voteCount = 0;
+            unsigned int wordIndex;
+            for (wordIndex = periodStart; wordIndex < periodEnd; wordIndex++) {
+                VoteBitMatrix::Word votedWord = votedRow[wordIndex];
+                if (votedWord == 0)
+                    continue;
+                unsigned int bit;
+                for (bit = 0; bit < VoteBitMatrix::bitsPerWord; bit++) {
+                    if (!((votedWord >> bit) & 1))
+                        continue;
+                    uint64_t rollCall = ((uint64_t)wordIndex * VoteBitMatrix::bitsPerWord) + bit;
+                    uint64_t hash = mixBits((rollCall << 1) | ((passRow[wordIndex] >> bit) & 1));
+                    unsigned int bin = (unsigned int)(((hash >> 32) * valueCount) >> 32);
+                    SketchValue value = std::min((SketchValue)hash, emptySketchValue - 1);
+                    sketch[bin] = std::min(sketch[bin], value);
+                    voteCount++;
+                }
+            }
+            if (voteCount < minSketchVotes)
+                continue;
+
+            // Fill the empty bins from the next bin a vote fell into, wrapping around
+            found = sketch;
+            unsigned short bin;
+            for (bin = 0; bin < valueCount; bin++) {
+                if (found[bin] != emptySketchValue)
+                    continue;
+                unsigned short distance = 1;
+                while (found[(bin + distance) % valueCount] == emptySketchValue)
+                    distance++;
+                uint64_t hash = mixBits(((uint64_t)found[(bin + distance) % valueCount] << 16) | distance);
+                sketch[bin] = std::min((SketchValue)hash, emptySketchValue - 1);
+            }
+            sketches.insert(sketches.end(), sketch.begin(), sketch.end());
+            SketchOwner owner;
+            owner._period = periodStart / periodWords;
+            owner._member = member;
+            owners.push_back(owner);
+        } // For each period
+    } // For each member
+}
+
+/* Lists the pairs of members sharing a bucket in any band of any period, each once,
+    as the lower member in the high half and the higher in the low half, in order */
+void SketchClusterFactory::findCandidatePairs(const vector<SketchValue>& sketches,
+                                              const vector<SketchOwner>& owners,
+                                              unsigned short bandCount, unsigned short valuesPerBand,
+                                              unsigned short bucketPairLimit, vector<uint32_t>& candidates)
+{
+    candidates.clear();
+    unsigned int valueCount = bandCount * valuesPerBand;
+    vector<pair<uint64_t, unsigned short> > buckets;
+    buckets.reserve(owners.size());
+    unsigned short band;
+    for (band = 0; band < bandCount; band++) {
+        // Sketches of different periods never share a bucket
+        buckets.clear();
+        size_t sketchIndex;
+        for (sketchIndex = 0; sketchIndex < owners.size(); sketchIndex++) {
+            const SketchValue* values = sketches.data() + (sketchIndex * valueCount) + (band * valuesPerBand);
+            uint64_t key = mixBits(((uint64_t)owners[sketchIndex]._period << 16) | band);
+            unsigned short valueIndex;
+            for (valueIndex = 0; valueIndex < valuesPerBand; valueIndex++)
+                key = mixBits(key ^ values[valueIndex]) + valueIndex;
+            buckets.push_back(std::make_pair(key, owners[sketchIndex]._member));
+        }
+        std::sort(buckets.begin(), buckets.end());
+
+        // Members in a bucket are in order, so each pair comes out lower member first
+        size_t bucketStart = 0;
+        while (bucketStart < buckets.size()) {
+            size_t bucketEnd = bucketStart + 1;
+            while ((bucketEnd < buckets.size()) && (buckets[bucketEnd].first == buckets[bucketStart].first))
+                bucketEnd++;
+            size_t index1, index2;
+            for (index1 = bucketStart; index1 < bucketEnd; index1++)
+                for (index2 = index1 + 1; (index2 < bucketEnd) && (index2 <= index1 + bucketPairLimit); index2++)
+                    candidates.push_back(((uint32_t)buckets[index1].second << 16) | buckets[index2].second);
+            bucketStart = bucketEnd;
+        }
+    } // For each band
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+}
+
+/* Clusters a set of votes both ways, given the exact differences for the same votes
+    and metric, and compares the results */
+void SketchClusterFactory::debugCompareExact(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                                             const VoteDiffMatrix& differences, short noiseThreshold,
+                                             VoteFactory::DiffMetric metric)
+{
+    typedef std::chrono::steady_clock Clock;
+    unsigned short memberCount = voted.getMemberCount();
+    if (differences.size() != memberCount) {
+        cerr << "Comparison failed, differences are for " << differences.size() << " members, votes for "
+             << memberCount << endl;
+        return;
+    }
+
+    // The differences counted here should be the ones given
+    MemberDifferences memberDifferences(passVotes, voted, metric);
+    unsigned long mismatches = 0;
+    unsigned short member1, member2;
+    for (member1 = 1; member1 < memberCount; member1++)
+        for (member2 = 0; member2 < member1; member2++)
+            if (memberDifferences.get(member1, member2) != differences.get(member1, member2))
+                mismatches++;
+
+    Clock::time_point start = Clock::now();
+    CongressGroupVector exactGroups;
+    Dendrogram dendrogram;
+    dendrogram.build(differences);
+    dendrogram.cut(noiseThreshold, 1, exactGroups);
+    double exactTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    start = Clock::now();
+    CongressGroupVector sketchGroups;
+    formClusters(passVotes, voted, sketchGroups, noiseThreshold, 0, metric);
+    double sketchTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    // Count the pairs exact clustering put together that are together here too
+    vector<unsigned short> sketchGroupIndexes(memberCount);
+    unsigned short groupIndex;
+    for (groupIndex = 0; groupIndex < sketchGroups.size(); groupIndex++) {
+        CongressGroup::const_iterator member;
+        for (member = sketchGroups[groupIndex].begin(); member != sketchGroups[groupIndex].end(); member++)
+            sketchGroupIndexes[*member] = groupIndex;
+    }
+    unsigned long exactPairs = 0, foundPairs = 0;
+    CongressGroupVector::const_iterator group;
+    for (group = exactGroups.begin(); group != exactGroups.end(); group++) {
+        vector<unsigned short> members;
+        group->getMembers(members);
+        size_t index1, index2;
+        for (index1 = 1; index1 < members.size(); index1++)
+            for (index2 = 0; index2 < index1; index2++) {
+                exactPairs++;
+                if (sketchGroupIndexes[members[index1]] == sketchGroupIndexes[members[index2]])
+                    foundPairs++;
+            }
+    }
+
+    // Every group should be as tight as complete linkage makes them
+    unsigned short wideGroups = 0;
+    for (group = sketchGroups.begin(); group != sketchGroups.end(); group++) {
+        vector<unsigned short> members;
+        group->getMembers(members);
+        size_t index1, index2;
+        bool wide = false;
+        for (index1 = 1; (index1 < members.size()) && !wide; index1++)
+            for (index2 = 0; (index2 < index1) && !wide; index2++)
+                wide = (differences.get(members[index1], members[index2]) > noiseThreshold);
+        if (wide)
+            wideGroups++;
+    }
+
+    cerr << memberCount << " members, threshold " << noiseThreshold << ": exact " << exactGroups.size()
+         << " groups in " << exactTime << " ms, sketch " << sketchGroups.size() << " groups in "
+         << sketchTime << " ms, " << foundPairs << " of " << exactPairs << " grouped pairs found";
+    if (exactPairs > 0)
+        cerr << " (" << ((100.0 * foundPairs) / exactPairs) << "%)";
+    cerr << endl;
+    if (mismatches > 0)
+        cerr << "WARNING: " << mismatches << " member differences do not match those given" << endl;
+    if (wideGroups > 0)
+        cerr << "WARNING: " << wideGroups << " groups have members further apart than the threshold" << endl;
+}
+
+/* Times clustering made up votes for the given number of members, spread over the
+    given number of two year sessions, and checks every group is within the threshold */
+void SketchClusterFactory::debugBenchmark(unsigned short memberCount, unsigned short sessionCount,
+                                          bool compareExact)
+{
+    typedef std::chrono::steady_clock Clock;
+    /* Roll call counts are kept in a short in SessionVotes, which the exact comparison
+        needs, so fewer roll calls per session are made up than a modern House holds */
+    const unsigned int rollCallsPerSession = 250;
+    const short noiseThreshold = 150;
+    if (sessionCount < 1)
+        sessionCount = 1;
+    sessionCount = std::min<unsigned int>(sessionCount, std::numeric_limits<short>::max() / rollCallsPerSession);
+    unsigned int rollCallCount = sessionCount * rollCallsPerSession;
+
+    /* Members are numbered in the order they joined, and serve up to six sessions.
+        Each roll call has a position for each party, the same for both on some. Every
+        member strays from their party at their own rate, and misses a few votes.
+        Hashing the indexes does all this without depending on a random number
+        generator */
+    VoteBitMatrix passVotes, voted;
+    passVotes.reset(memberCount, rollCallCount);
+    voted.reset(memberCount, rollCallCount);
+    unsigned int rollCall;
+    for (rollCall = 0; rollCall < rollCallCount; rollCall++) {
+        passVotes.addRollCall();
+        voted.addRollCall();
+    }
+    unsigned short member;
+    for (member = 0; member < memberCount; member++) {
+        uint64_t memberHash = mixBits(member + 1);
+        unsigned int firstSession = ((unsigned int)member * sessionCount) / memberCount;
+        unsigned int lastSession = std::min<unsigned int>(firstSession + 1 + (memberHash % 6), sessionCount);
+        unsigned int strayPercent = 1 + ((memberHash >> 8) % 12);
+        unsigned int party = member % 2;
+        for (rollCall = firstSession * rollCallsPerSession; rollCall < lastSession * rollCallsPerSession; rollCall++) {
+            uint64_t voteHash = mixBits(((uint64_t)member << 32) | rollCall);
+            if ((voteHash % 100) < 3)
+                continue; // Missed the vote
+            uint64_t rollCallHash = mixBits(~(uint64_t)rollCall);
+            bool partyPosition = (rollCallHash & 1) != 0;
+            if ((party == 1) && (((rollCallHash >> 8) % 100) >= 30)) // Most roll calls split the parties
+                partyPosition = !partyPosition;
+            if (((voteHash >> 16) % 100) < strayPercent)
+                partyPosition = !partyPosition;
+            voted.set(member, rollCall);
+            if (partyPosition)
+                passVotes.set(member, rollCall);
+        }
+    } // For each member
+
+    Clock::time_point start = Clock::now();
+    CongressGroupVector groups;
+    formClusters(passVotes, voted, groups, noiseThreshold, 0);
+    double sketchTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    // Check every group is within the threshold, and find the largest
+    MemberDifferences differences(passVotes, voted, VoteFactory::metricAbsenceCorrected);
+    unsigned short wideGroups = 0;
+    size_t largestGroup = 0;
+    CongressGroupVector::const_iterator group;
+    for (group = groups.begin(); group != groups.end(); group++) {
+        vector<unsigned short> members;
+        group->getMembers(members);
+        largestGroup = std::max(largestGroup, members.size());
+        size_t index1, index2;
+        bool wide = false;
+        for (index1 = 1; (index1 < members.size()) && !wide; index1++)
+            for (index2 = 0; (index2 < index1) && !wide; index2++)
+                wide = (differences.get(members[index1], members[index2]) > noiseThreshold);
+        if (wide)
+            wideGroups++;
+    }
+    cerr << memberCount << " members over " << sessionCount << " sessions (" << rollCallCount
+         << " roll calls): " << groups.size() << " groups in " << sketchTime << " ms, largest "
+         << largestGroup << "; a matrix of every pair holds " << ((unsigned long)memberCount * (memberCount - 1) / 2)
+         << " differences" << endl;
+    if (wideGroups > 0)
+        cerr << "WARNING: " << wideGroups << " groups have members further apart than the threshold" << endl;
+
+    if (compareExact) {
+        SessionVotes votes;
+        start = Clock::now();
+        VoteDiffCounter::countDifferences(passVotes, voted, votes._differences, votes._bothVoted);
+        votes._billCount = (short)rollCallCount;
+        votes._passVotes = passVotes;
+        votes._voted = voted;
+        VoteDiffMatrix exactDifferences;
+        VoteFactory::normalizeVoteMatrix(votes, exactDifferences, VoteFactory::metricAbsenceCorrected);
+        cerr << "Counting every pair took " << std::chrono::duration<double, std::milli>(Clock::now() - start).count()
+             << " ms" << endl;
+        debugCompareExact(passVotes, voted, exactDifferences, noiseThreshold);
+    }
+}
@@ -0,0 +1,140 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class clusters sets of Congresspeople too large for a matrix of the
+    differences between every pair, such as every member of the House since
+    1789. Complete linkage needs every pair's difference; with 12,000 members
+    that is 72 million pairs, each compared over tens of thousands of roll
+    calls, and GroupDistanceMap would need a tree node for each. Yet nearly all
+    of those pairs never served together, or voted far apart, and could never be
+    in the same group.
+
+    So the pairs worth checking are found first from short sketches of each
+    member's votes. Every vote cast is a token: the roll call and which way the
+    member voted. The MinHash of these sets estimates the share of tokens two
+    members have in common, which is the agreement Jaccard difference measures.
+    Over a whole career that share is low for two members who served different
+    spans, however closely they agreed while both were there, so each member is
+    sketched separately for each period of a few hundred roll calls they voted in,
+    and only sketches of the same period are compared. Each sketch is split into
+    bands of a few values each, and members with an identical band share a
+    bucket. Members who agree often share at least one bucket with high
+    probability; members who rarely served together almost never do. Only pairs
+    sharing a bucket become candidates. A huge bucket, such as a party in one
+    session voting in lock step, pairs each member with only a limited number of
+    those after it, since other bands still link the rest.
+
+    The candidates are then clustered with complete linkage, using the exact
+    differences counted from the vote bits. The closest pair of clusters joined
+    by a candidate is merged first, and the difference between two clusters is
+    the largest between any of their members, all counted exactly. So every
+    group returned has every pair of members within the threshold, just as
+    ClusterFactory guarantees. The approximation is only that clusters with no
+    candidate between them are never compared, so a few groups may be split that
+    exact clustering would merge.
+
+    Members are numbered by their row in the vote bits, and a cluster by its
+    lowest member, the same as ClusterFactory. The results are in the same form
+    ClusterFactory returns, so the rest of the program can use them unchanged.
+    The votes of one session only cover that session's members, so to cluster
+    many sessions, GraphFactory::readSessionVotes() joins them into one set of
+    members first; GraphFactory::makeSessionGroups() does both */
+#ifndef SKETCH_CLUSTER_FACTORY_H_INCLUDED
+#define SKETCH_CLUSTER_FACTORY_H_INCLUDED
+
+#include<vector>
+#include<cstdint>
+#include"voteBitMatrix.h"
+#include"voteDiffMatrix.h"
+
+/* NOTE: Uses VoteFactory::DiffMetric from voteFactory.h and CongressGroupVector from
+    clusterFactory.h. The headers are not included here; callers need them anyway to
+    get the votes and use the results */
+
+using std::vector;
+
+class SketchClusterFactory
+{
+public:
+    /* Given the vote bits of the Congresspeople and the level of vote differences
+        considered to be noise, returns the groups of Congresspeople. The minimum group
+        count stops merging early, as for ClusterFactory::formClusters(). Differences are
+        on the same scale as VoteFactory gives for the metric. Absence corrected is the
+        default since most members of a long period never voted together; under the
+        other metrics, absences push every member away from everyone else.
+
+        Each member gets a sketch for each period of about the given number of roll
+        calls. Shorter periods find more of the pairs that belong together, at the cost of
+        more sketches. Each sketch has the given number of bands of the given number of
+        values. More bands also find more of those pairs, at the cost of more candidates
+        to check. More values per band make a shared bucket rarer for members who differ.
+        A bucket larger than the pair limit pairs each member with only that many of the
+        members after it */
+    static void formClusters(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                             CongressGroupVector& congressMatchGroups,
+                             short noiseThreshold = 100, short minGroups = 0,
+                             VoteFactory::DiffMetric metric = VoteFactory::metricAbsenceCorrected,
+                             unsigned short sketchRollCalls = 256, unsigned short bandCount = 16,
+                             unsigned short valuesPerBand = 4, unsigned short bucketPairLimit = 64);
+
+    /* Clusters a set of votes both ways, given the exact differences for the same votes
+        and metric, and compares the results: the time taken, the number of groups, the
+        share of pairs grouped together by exact clustering that are also grouped together
+        here, and whether every group is within the threshold. Results are written to
+        standard error */
+    static void debugCompareExact(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                                  const VoteDiffMatrix& differences, short noiseThreshold = 100,
+                                  VoteFactory::DiffMetric metric = VoteFactory::metricAbsenceCorrected);
+
+    /* Times clustering made up votes for the given number of members, spread over the
+        given number of two year sessions, each serving a few of them, and checks every
+        group is within the threshold. If asked, also counts every pair exactly and
+        compares with debugCompareExact(), which takes far longer. Results are written to
+        standard error */
+    static void debugBenchmark(unsigned short memberCount = 12000, unsigned short sessionCount = 115,
+                               bool compareExact = false);
+
+private:
+    // One value of a member's sketch
+    typedef uint32_t SketchValue;
+
+    // Whose votes, and from which period of roll calls, a sketch is made from
+    struct SketchOwner {
+        unsigned int _period;
+        unsigned short _member;
+    };
+
+    /* Finds the sketches of each member's votes in each period of the given number of
+        words of roll calls they voted enough in, the given number of values each. The
+        owner of each sketch is listed in the same order */
+    static void findSketches(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                             unsigned int periodWords, unsigned short valueCount,
+                             vector<SketchValue>& sketches, vector<SketchOwner>& owners);
+
+    /* Lists the pairs of members sharing a bucket in any band of any period, each once,
+        as the lower member in the high half and the higher in the low half, in order */
+    static void findCandidatePairs(const vector<SketchValue>& sketches, const vector<SketchOwner>& owners,
+                                   unsigned short bandCount, unsigned short valuesPerBand,
+                                   unsigned short bucketPairLimit, vector<uint32_t>& candidates);
+};
+
+#endif // SKETCH_CLUSTER_FACTORY_H_INCLUDED
@@ -0,0 +1,93 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile also has
+    a link to the code depository)
+*/
+
+// Bit per Congressperson per roll call storage for a whole session
+#include<vector>
+#include<bitset>
+#include<stdexcept>
+#include"voteBitMatrix.h"
+
+using std::vector;
+using std::bitset;
+
+// Number of bits set in one row. Indexes are not checked
+unsigned int VoteBitMatrix::countRow(unsigned short member) const
+{
+    const Word* row = getRow(member);
+    unsigned int result = 0;
+    unsigned int wordIndex;
+    for (wordIndex = 0; wordIndex < getWordsPerRow(); wordIndex++)
+        result += bitset<bitsPerWord>(row[wordIndex]).count();
+    return result;
+}
+
+VoteBitMatrix::VoteBitMatrix() : _bits()
+{
+    _memberCount = 0;
+    _rollCallCount = 0;
+    _rowStride = 0;
+}
+
+/* Clears the matrix and sizes it for the given number of Congresspeople and
+    the largest number of roll calls that will be added */
+void VoteBitMatrix::reset(unsigned short memberCount, unsigned int rollCallCapacity)
+{
+    _memberCount = memberCount;
+    _rollCallCount = 0;
+    _rowStride = (rollCallCapacity + bitsPerWord - 1) / bitsPerWord;
+    /* Always allocate at least one word, so getRow() is valid for an empty
+        matrix with members */
+    if (_rowStride == 0)
+        _rowStride = 1;
+    _bits.assign(memberCount * (size_t)_rowStride, 0);
+}
+
+/* Appends every roll call from another matrix for the same Congresspeople.
+    Throws out_of_range if the result exceeds the capacity */
+void VoteBitMatrix::append(const VoteBitMatrix& other)
+{
+    if (other._memberCount != _memberCount)
+        throw std::out_of_range("VoteBitMatrix append with different member count");
+    if ((_rollCallCount + other._rollCallCount) > (_rowStride * bitsPerWord))
+        throw std::out_of_range("VoteBitMatrix roll call capacity exceeded");
+
+    /* The other matrix's roll calls start partway through a word of this one,
+        so each source word is split across two destination words. The bits past
+        the end of the source are zero, so they can be ORed in without masking */
+    unsigned int wordOffset = _rollCallCount / bitsPerWord;
+    unsigned int bitOffset = _rollCallCount % bitsPerWord;
+    unsigned int sourceWords = other.getWordsPerRow();
+    unsigned short member;
+    for (member = 0; member < _memberCount; member++) {
+        Word* destination = getRow(member) + wordOffset;
+        const Word* source = other.getRow(member);
+        unsigned int wordIndex;
+        for (wordIndex = 0; wordIndex < sourceWords; wordIndex++) {
+            destination[wordIndex] |= source[wordIndex] << bitOffset;
+            // Shifting by a full word is undefined, and has nothing to carry anyway
+            if ((bitOffset != 0) && ((wordOffset + wordIndex + 1) < _rowStride))
+                destination[wordIndex + 1] |= source[wordIndex] >> (bitsPerWord - bitOffset);
+        }
+    } // For each row
+    _rollCallCount += other._rollCallCount;
+}
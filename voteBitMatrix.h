@@ -0,0 +1,126 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class holds one bit per Congressperson per roll call for an entire
+    session. Each Congressperson gets a row, with the roll calls packed 64 to
+    a word. Rows are allocated for the largest number of roll calls expected
+    up front, so adding roll calls never moves data. Bits past the last roll
+    call in a row are always zero, which lets word at a time code ignore them.
+
+    Unlike the bitset blocks used while reading, the size is set at run time,
+    so a whole session can be kept in a single allocation */
+#ifndef VOTE_BIT_MATRIX_H_INCLUDED
+#define VOTE_BIT_MATRIX_H_INCLUDED
+
+#include<vector>
+#include<cstdint>
+#include<stdexcept>
+
+using std::vector;
+
+class VoteBitMatrix
+{
+public:
+    typedef uint64_t Word;
+    static const unsigned int bitsPerWord = 64;
+
+    VoteBitMatrix();
+
+    /* Clears the matrix and sizes it for the given number of Congresspeople and
+        the largest number of roll calls that will be added */
+    void reset(unsigned short memberCount, unsigned int rollCallCapacity);
+
+    unsigned short getMemberCount(void) const;
+    unsigned int getRollCallCount(void) const;
+
+    // Number of words in each row that hold roll calls
+    unsigned int getWordsPerRow(void) const;
+
+    /* Adds a roll call with no bits set. Returns its index. Throws out_of_range
+        if the matrix is already at capacity */
+    unsigned int addRollCall(void);
+
+    // Sets or tests the bit for a Congressperson on a roll call. Indexes are not checked
+    void set(unsigned short member, unsigned int rollCall);
+    bool test(unsigned short member, unsigned int rollCall) const;
+
+    // Number of bits set in one row. Indexes are not checked
+    unsigned int countRow(unsigned short member) const;
+
+    // Direct access to the words of one row. Indexes are not checked
+    const Word* getRow(unsigned short member) const;
+    Word* getRow(unsigned short member);
+
+    /* Appends every roll call from another matrix for the same Congresspeople.
+        Throws out_of_range if the result exceeds the capacity */
+    void append(const VoteBitMatrix& other);
+
+private:
+    vector<Word> _bits;
+    unsigned short _memberCount;
+    unsigned int _rollCallCount;
+    unsigned int _rowStride; // Words allocated per row
+};
+
+inline unsigned short VoteBitMatrix::getMemberCount(void) const
+{
+    return _memberCount;
+}
+
+inline unsigned int VoteBitMatrix::getRollCallCount(void) const
+{
+    return _rollCallCount;
+}
+
+inline unsigned int VoteBitMatrix::getWordsPerRow(void) const
+{
+    return (_rollCallCount + bitsPerWord - 1) / bitsPerWord;
+}
+
+inline unsigned int VoteBitMatrix::addRollCall(void)
+{
+    if (_rollCallCount >= (_rowStride * bitsPerWord))
+        throw std::out_of_range("VoteBitMatrix roll call capacity exceeded");
+    return _rollCallCount++;
+}
+
+inline void VoteBitMatrix::set(unsigned short member, unsigned int rollCall)
+{
+    _bits[(member * (size_t)_rowStride) + (rollCall / bitsPerWord)] |= ((Word)1) << (rollCall % bitsPerWord);
+}
+
+inline bool VoteBitMatrix::test(unsigned short member, unsigned int rollCall) const
+{
+    return ((_bits[(member * (size_t)_rowStride) + (rollCall / bitsPerWord)] >> (rollCall % bitsPerWord)) & 1) != 0;
+}
+
+inline const VoteBitMatrix::Word* VoteBitMatrix::getRow(unsigned short member) const
+{
+    return &_bits[0] + (member * (size_t)_rowStride);
+}
+
+inline VoteBitMatrix::Word* VoteBitMatrix::getRow(unsigned short member)
+{
+    return &_bits[0] + (member * (size_t)_rowStride);
+}
+
+#endif // VOTE_BIT_MATRIX_H_INCLUDED
@@ -0,0 +1,373 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile also has
+    a link to the code depository)
+*/
+
+// Save and load the results of reading a session's data files
+#include<string>
+#include<vector>
+#include<fstream>
+#include<sstream>
+#include<iostream>
+#include<filesystem>
+#include<system_error>
+#include<cstring>
+#include<cstdint>
+#include"xmlParser.h" // Defines ROLL_DIRECTORY
+#include"congressData.h"
+#include"rollCallManifest.h"
+#include"voteFactory.h"
+#include"mappedFile.h"
+#include"voteCache.h"
+
+using std::string;
+using std::vector;
+using std::ofstream;
+using std::stringstream;
+using std::cerr;
+using std::endl;
+using std::ios_base;
+
+/* Identifies the file and its layout. Change the version whenever the layout
+    or the meaning of the saved data changes, so old files are ignored */
+static const char cacheMagic[8] = { 'C', 'R', 'V', 'C', 'A', 'C', 'H', 'E' };
+static const uint32_t cacheVersion = 3;
+
+/* Writes binary values to the cache file. Errors are checked once at the end,
+    since the stream ignores writes after the first failure */
+class CacheWriter
+{
+public:
+    explicit CacheWriter(ofstream& file) : _file(file) {}
+
+    template<typename T> void write(const T& value)
+    {
+        _file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write(const void* data, size_t size)
+    {
+        _file.write(static_cast<const char*>(data), size);
+    }
+
+    void writeString(const string& value)
+    {
+        write((uint32_t)value.size());
+        write(value.data(), value.size());
+    }
+
+private:
+    ofstream& _file;
+};
+
+/* Reads binary values from the mapped cache file. A read past the end marks
+    the file bad and returns nothing, so a truncated file is caught without
+    checking every call */
+class CacheReader
+{
+public:
+    CacheReader(const char* data, size_t size) : _next(data), _end(data + size), _isGood(true) {}
+
+    bool isGood(void) const { return _isGood; }
+
+    template<typename T> bool read(T& value)
+    {
+        return read(&value, sizeof(T));
+    }
+
+    bool read(void* data, size_t size)
+    {
+        if (!_isGood || ((size_t)(_end - _next) < size)) {
+            _isGood = false;
+            return false;
+        }
+        // The file data is not aligned, so copy rather than cast
+        memcpy(data, _next, size);
+        _next += size;
+        return true;
+    }
+
+    bool readString(string& value)
+    {
+        uint32_t size;
+        if (!read(size) || ((size_t)(_end - _next) < size)) {
+            _isGood = false;
+            return false;
+        }
+        value.assign(_next, size);
+        _next += size;
+        return true;
+    }
+
+private:
+    const char* _next;
+    const char* _end;
+    bool _isGood;
+};
+
+// Name of the file holding saved data for the session
+string VoteCache::getCacheFileName(const RollCallManifest& rollCalls)
+{
+    stringstream fileName;
+    fileName << ROLL_DIRECTORY << "/votes" << rollCalls.getFirstYear() << "-"
+             << rollCalls.getLastYear() << ".cache";
+    return fileName.str();
+}
+
+// Finds the size and modification time of one file. Returns false if it can't be read
+static bool getFileStatus(const string& fileName, uint64_t& size, int64_t& modifyTime)
+{
+    std::error_code error;
+    std::filesystem::path filePath(fileName);
+    size = std::filesystem::file_size(filePath, error);
+    if (error)
+        return false;
+    modifyTime = std::filesystem::last_write_time(filePath, error).time_since_epoch().count();
+    return !error;
+}
+
+// Finds the stamps of every data file the session depends on. Returns false on error
+bool VoteCache::getFileStamps(const RollCallManifest& rollCalls, FileStampList& stamps)
+{
+    stamps.clear();
+    stamps.reserve(rollCalls.getRollCallCount() + 1);
+
+    FileStamp stamp;
+    stamp._year = 0;
+    stamp._rollCallNo = 0;
+    if (!getFileStatus(string(ROLL_DIRECTORY) + "/people.xml", stamp._size, stamp._modifyTime))
+        return false;
+    stamps.push_back(stamp);
+
+    // Roll calls packed in an archive are covered by the archive's stamp
+    if (rollCalls.isBundled()) {
+        stamp._year = -1;
+        if (!getFileStatus(rollCalls.getBundle().getFileName(), stamp._size, stamp._modifyTime))
+            return false;
+        stamps.push_back(stamp);
+        return true;
+    }
+
+    short year;
+    for (year = rollCalls.getFirstYear(); year <= rollCalls.getLastYear(); year++) {
+        const vector<int>& rollCallNos = rollCalls.getRollCalls(year);
+        vector<int>::const_iterator index;
+        for (index = rollCallNos.begin(); index != rollCallNos.end(); index++) {
+            stringstream fileName;
+            fileName << ROLL_DIRECTORY << "/h" << year << "-" << *index << ".xml";
+            stamp._year = year;
+            stamp._rollCallNo = *index;
+            if (!getFileStatus(fileName.str(), stamp._size, stamp._modifyTime))
+                return false;
+            stamps.push_back(stamp);
+        }
+    } // For each year
+    return true;
+}
+
+/* Loads the saved data for the session in the manifest. Returns false if there
+    is none, it can't be read, or any data file changed since it was saved. Roll
+    call files added after the last one saved are returned, so the caller can
+    read just those. The bit matrices have room for them */
+bool VoteCache::load(const RollCallManifest& rollCalls,
+                     CongressData::CongressPersonList& congressData,
+                     SessionVotes& votes, RollCallManifest::RollCallsByYear& newRollCalls)
+{
+    MappedFile file;
+    if (!file.open(getCacheFileName(rollCalls)))
+        return false; // Normal for the first run of a session
+    CacheReader reader(file.getData(), file.getSize());
+
+    char magic[sizeof(cacheMagic)];
+    uint32_t version;
+    short firstYear, lastYear;
+    reader.read(magic, sizeof(magic));
+    reader.read(version);
+    reader.read(firstYear);
+    reader.read(lastYear);
+    if (!reader.isGood() || (memcmp(magic, cacheMagic, sizeof(magic)) != 0) ||
+        (version != cacheVersion) || (firstYear != rollCalls.getFirstYear()) ||
+        (lastYear != rollCalls.getLastYear()))
+        return false;
+
+    FileStampList currentStamps;
+    if (!getFileStamps(rollCalls, currentStamps))
+        return false;
+    uint32_t stampCount;
+    if (!reader.read(stampCount) || (stampCount > currentStamps.size()))
+        return false;
+    FileStampList savedStamps(stampCount);
+    FileStampList::iterator savedIndex;
+    for (savedIndex = savedStamps.begin(); savedIndex != savedStamps.end(); savedIndex++) {
+        reader.read(savedIndex->_year);
+        reader.read(savedIndex->_rollCallNo);
+        reader.read(savedIndex->_size);
+        reader.read(savedIndex->_modifyTime);
+    }
+    if (!reader.isGood())
+        return false;
+
+    RollCallManifest::RollCallsByYear addedRollCalls;
+    /* Every data file read when the cache was saved must be unchanged. New roll call
+        files are fine if they all come after the saved ones, which is how a session in
+        progress grows. The saved votes are then exactly what reading the old files
+        again would give, and the new ones can be added to them. A file that is new but
+        sorts before a saved one means the data was redone; start over.
+        NOTE: Both lists are in manifest order, so they can be compared in one pass */
+    savedIndex = savedStamps.begin();
+    FileStampList::const_iterator stampIndex;
+    for (stampIndex = currentStamps.begin(); stampIndex != currentStamps.end(); stampIndex++) {
+        if ((savedIndex != savedStamps.end()) && (savedIndex->_year == stampIndex->_year) &&
+            (savedIndex->_rollCallNo == stampIndex->_rollCallNo)) {
+            if ((savedIndex->_size != stampIndex->_size) ||
+                (savedIndex->_modifyTime != stampIndex->_modifyTime))
+                return false;
+            savedIndex++;
+        }
+        else if ((savedIndex == savedStamps.end()) && (stampIndex->_year > 0))
+            addedRollCalls[stampIndex->_year].push_back(stampIndex->_rollCallNo);
+        else
+            return false;
+    }
+
+    uint16_t memberCount;
+    if (!reader.read(memberCount))
+        return false;
+    CongressData::CongressPersonList savedCongress(memberCount);
+    CongressData::CongressPersonList::iterator personIndex;
+    for (personIndex = savedCongress.begin(); personIndex != savedCongress.end(); personIndex++) {
+        reader.read(personIndex->_refNo);
+        reader.readString(personIndex->_name);
+        reader.readString(personIndex->_party);
+        reader.readString(personIndex->_state);
+    }
+
+    short billCount;
+    uint32_t rollCallCount;
+    reader.read(billCount);
+    reader.read(rollCallCount);
+    if (!reader.isGood() || (billCount < 0) || (rollCallCount != (uint32_t)billCount))
+        return false;
+
+    SessionVotes savedVotes;
+    savedVotes._billCount = billCount;
+    // Make room for every roll call in the manifest, in case new ones must be added
+    unsigned int rollCallCapacity = rollCalls.getRollCallCount();
+    if (rollCallCapacity < rollCallCount)
+        rollCallCapacity = rollCallCount;
+    VoteBitMatrix* bitMatrices[2] = { &savedVotes._passVotes, &savedVotes._voted };
+    unsigned short matrixIndex;
+    for (matrixIndex = 0; matrixIndex < 2; matrixIndex++) {
+        VoteBitMatrix& bits = *bitMatrices[matrixIndex];
+        bits.reset(memberCount, rollCallCapacity);
+        uint32_t rollCallIndex;
+        for (rollCallIndex = 0; rollCallIndex < rollCallCount; rollCallIndex++)
+            bits.addRollCall();
+        unsigned short member;
+        for (member = 0; member < memberCount; member++)
+            reader.read(bits.getRow(member), bits.getWordsPerRow() * sizeof(VoteBitMatrix::Word));
+    }
+
+    savedVotes._differences.assign(memberCount, 0);
+    reader.read(savedVotes._differences.getValues(), savedVotes._differences.getValueCount() * sizeof(short));
+    savedVotes._bothVoted.assign(memberCount, 0);
+    reader.read(savedVotes._bothVoted.getValues(), savedVotes._bothVoted.getValueCount() * sizeof(short));
+    if (!reader.isGood())
+        return false;
+
+    congressData.swap(savedCongress);
+    newRollCalls.swap(addedRollCalls);
+    votes = std::move(savedVotes);
+    return true;
+}
+
+/* Saves the data for the session in the manifest. The cache only saves time,
+    so failures are reported but otherwise ignored */
+void VoteCache::save(const RollCallManifest& rollCalls, const CongressData& congressData,
+                     const SessionVotes& votes)
+{
+    FileStampList stamps;
+    if (!getFileStamps(rollCalls, stamps)) {
+        cerr << "WARNING: Vote data not saved, data file status unavailable" << endl;
+        return;
+    }
+
+    /* Write to a temporary file and rename it when done, so a run that is
+        interrupted never leaves a partial file that looks valid */
+    string fileName(getCacheFileName(rollCalls));
+    string tempFileName(fileName + ".tmp");
+    {
+        ofstream file(tempFileName.c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
+        CacheWriter writer(file);
+        writer.write(cacheMagic, sizeof(cacheMagic));
+        writer.write(cacheVersion);
+        writer.write(rollCalls.getFirstYear());
+        writer.write(rollCalls.getLastYear());
+
+        writer.write((uint32_t)stamps.size());
+        FileStampList::const_iterator stampIndex;
+        for (stampIndex = stamps.begin(); stampIndex != stamps.end(); stampIndex++) {
+            writer.write(stampIndex->_year);
+            writer.write(stampIndex->_rollCallNo);
+            writer.write(stampIndex->_size);
+            writer.write(stampIndex->_modifyTime);
+        }
+
+        uint16_t memberCount = congressData.getSize();
+        writer.write(memberCount);
+        unsigned short member;
+        for (member = 0; member < memberCount; member++) {
+            const CongressData::CongressPerson& person = congressData.getData(member);
+            writer.write(person._refNo);
+            writer.writeString(person._name);
+            writer.writeString(person._party);
+            writer.writeString(person._state);
+        }
+
+        writer.write(votes._billCount);
+        writer.write((uint32_t)votes._passVotes.getRollCallCount());
+        const VoteBitMatrix* bitMatrices[2] = { &votes._passVotes, &votes._voted };
+        unsigned short matrixIndex;
+        for (matrixIndex = 0; matrixIndex < 2; matrixIndex++)
+            for (member = 0; member < memberCount; member++)
+                writer.write(bitMatrices[matrixIndex]->getRow(member),
+                             bitMatrices[matrixIndex]->getWordsPerRow() * sizeof(VoteBitMatrix::Word));
+
+        writer.write(votes._differences.getValues(), votes._differences.getValueCount() * sizeof(short));
+        writer.write(votes._bothVoted.getValues(), votes._bothVoted.getValueCount() * sizeof(short));
+
+        file.close();
+        if (file.fail()) {
+            cerr << "WARNING: Vote data not saved, write to " << tempFileName << " failed" << endl;
+            std::error_code error;
+            std::filesystem::remove(tempFileName, error);
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempFileName, fileName, error);
+    if (error) {
+        cerr << "WARNING: Vote data not saved, rename to " << fileName << " failed: "
+             << error.message() << endl;
+        std::filesystem::remove(tempFileName, error);
+    }
+}
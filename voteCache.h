@@ -0,0 +1,88 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class saves the results of reading a session's data files in a binary
+    file, and loads them again on later runs. Past sessions never change, so
+    reading thousands of XML files every run is wasted effort. The file holds
+    the Congressperson list, the vote bits, and the raw vote counts for each pair,
+    everything needed to go straight to clustering.
+
+    The saved data is only used if every source file is unchanged. The size
+    and modification time of people.xml and each roll call file (or the
+    archive holding them) are stored with the data and compared on load; any
+    difference, or any roll call file added or removed, means the files must
+    be read again.
+
+    During a session new roll call files appear every few days. If the only
+    change is new files that sort after every saved one, the saved data is
+    still used, and only the new files need to be read and added. The file
+    list saved with the data records exactly which roll calls it includes.
+
+    The file format is the memory layout of this machine. It is a cache, not
+    an exchange format, so it is not meant to be moved between machines */
+#ifndef VOTE_CACHE_H_INCLUDED
+#define VOTE_CACHE_H_INCLUDED
+
+#include<vector>
+#include<string>
+#include<cstdint>
+
+/* NOTE: Uses CongressData, RollCallManifest, and SessionVotes. Their headers are
+    not included here; callers need them anyway to do anything with the results */
+
+using std::vector;
+using std::string;
+
+class VoteCache
+{
+public:
+    /* Loads the saved data for the session in the manifest. Returns false if there
+        is none, it can't be read, or any data file changed since it was saved. Roll
+        call files added after the last one saved are returned, so the caller can
+        read just those. The bit matrices have room for them */
+    static bool load(const RollCallManifest& rollCalls,
+                     CongressData::CongressPersonList& congressData,
+                     SessionVotes& votes, RollCallManifest::RollCallsByYear& newRollCalls);
+
+    /* Saves the data for the session in the manifest. The cache only saves time,
+        so failures are reported but otherwise ignored */
+    static void save(const RollCallManifest& rollCalls, const CongressData& congressData,
+                     const SessionVotes& votes);
+
+private:
+    // Identifies the version of a data file. Year zero is people.xml, -1 a roll call archive
+    struct FileStamp {
+        short _year;
+        int _rollCallNo;
+        uint64_t _size;
+        int64_t _modifyTime;
+    };
+    typedef vector<FileStamp> FileStampList;
+
+    // Finds the stamps of every data file the session depends on. Returns false on error
+    static bool getFileStamps(const RollCallManifest& rollCalls, FileStampList& stamps);
+
+    // Name of the file holding saved data for the session
+    static string getCacheFileName(const RollCallManifest& rollCalls);
+};
+
+#endif // VOTE_CACHE_H_INCLUDED
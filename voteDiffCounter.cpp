@@ -0,0 +1,500 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile also has
+    a link to the code depository)
+*/
+
+/* Count vote differences between every pair of Congresspeople from the vote
+    bits of a whole session. Each routine counts the matching votes of one
+    pair; the differences follow from the roll call count */
+#include<string>
+#include<vector>
+#include<iostream>
+#include<chrono>
+#include<stdexcept>
+#include<algorithm>
+#include<cstdint>
+#include<thread>
+#include"cpuFeatures.h"
+#include"congressData.h"
+#include"voteDiffCounter.h"
+
+#ifdef HAVE_X86_SIMD
+#include<immintrin.h>
+#endif
+
+using std::string;
+using std::vector;
+using std::cerr;
+using std::endl;
+
+/* Counts the set bits in a word without special instructions. This is the
+    classic method of adding adjacent bit fields in parallel */
+static inline unsigned int countBits(uint64_t value)
+{
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (unsigned int)((value * 0x0101010101010101ULL) >> 56);
+}
+
+/* Two members cast the same vote on a roll call if both voted and their pass
+    bits are equal. Every routine counts these bits, and the ones where both voted */
+VoteDiffCounter::PairCounts VoteDiffCounter::countScalar(const Word* passFirst, const Word* votedFirst,
+                                                         const Word* passSecond, const Word* votedSecond,
+                                                         unsigned int wordCount)
+{
+    PairCounts result = { 0, 0 };
+    unsigned int index;
+    for (index = 0; index < wordCount; index++) {
+        uint64_t bothVoted = votedFirst[index] & votedSecond[index];
+        result._sameVotes += countBits(bothVoted & ~(passFirst[index] ^ passSecond[index]));
+        result._bothVoted += countBits(bothVoted);
+    }
+    return result;
+}
+
+#ifdef HAVE_X86_SIMD
+
+/* The bit count instruction is only used if the function is compiled for it,
+    so the count is written out in each routine that needs it rather than in
+    a shared helper */
+#if defined(__GNUC__)
+#define COUNT_BITS_INSTRUCTION(value) ((unsigned int)__builtin_popcountll(value))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define COUNT_BITS_INSTRUCTION(value) ((unsigned int)__popcnt64(value))
+#else
+#define COUNT_BITS_INSTRUCTION(value) countBits(value)
+#endif
+
+VoteDiffCounter::PairCounts TARGET_POPCNT VoteDiffCounter::countPopcnt(const Word* passFirst, const Word* votedFirst,
+                                                                       const Word* passSecond, const Word* votedSecond,
+                                                                       unsigned int wordCount)
+{
+    PairCounts result = { 0, 0 };
+    unsigned int index;
+    for (index = 0; index < wordCount; index++) {
+        uint64_t bothVoted = votedFirst[index] & votedSecond[index];
+        result._sameVotes += COUNT_BITS_INSTRUCTION(bothVoted & ~(passFirst[index] ^ passSecond[index]));
+        result._bothVoted += COUNT_BITS_INSTRUCTION(bothVoted);
+    }
+    return result;
+}
+
+/* Counts the bits in each word of an AVX2 register. AVX2 has no bit count
+    instruction. Instead, each 4 bit half of every byte is used as an index into
+    a table of bit counts, using the byte shuffle. Adding the halves gives the
+    count per byte, and the sum of absolute differences against zero adds those
+    into one count per word */
+static inline __m256i TARGET_AVX2 countWordBitsAvx2(__m256i value, __m256i countTable, __m256i lowHalf)
+{
+    __m256i lowCounts = _mm256_shuffle_epi8(countTable, _mm256_and_si256(value, lowHalf));
+    __m256i highCounts = _mm256_shuffle_epi8(countTable, _mm256_and_si256(_mm256_srli_epi16(value, 4), lowHalf));
+    return _mm256_sad_epu8(_mm256_add_epi8(lowCounts, highCounts), _mm256_setzero_si256());
+}
+
+// Adds the four words of an AVX2 register
+static inline unsigned int TARGET_AVX2 sumWordsAvx2(__m256i value)
+{
+    uint64_t wordTotals[4];
+    _mm256_storeu_si256((__m256i*)wordTotals, value);
+    return (unsigned int)(wordTotals[0] + wordTotals[1] + wordTotals[2] + wordTotals[3]);
+}
+
+VoteDiffCounter::PairCounts TARGET_AVX2 VoteDiffCounter::countAvx2(const Word* passFirst, const Word* votedFirst,
+                                                                   const Word* passSecond, const Word* votedSecond,
+                                                                   unsigned int wordCount)
+{
+    const __m256i countTable = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowHalf = _mm256_set1_epi8(0x0F);
+    __m256i sameTotal = _mm256_setzero_si256();
+    __m256i bothTotal = _mm256_setzero_si256();
+    unsigned int index = 0;
+    for (; (index + 4) <= wordCount; index += 4) {
+        __m256i passA = _mm256_loadu_si256((const __m256i*)(passFirst + index));
+        __m256i votedA = _mm256_loadu_si256((const __m256i*)(votedFirst + index));
+        __m256i passB = _mm256_loadu_si256((const __m256i*)(passSecond + index));
+        __m256i votedB = _mm256_loadu_si256((const __m256i*)(votedSecond + index));
+        __m256i both = _mm256_and_si256(votedA, votedB);
+        __m256i same = _mm256_andnot_si256(_mm256_xor_si256(passA, passB), both);
+        sameTotal = _mm256_add_epi64(sameTotal, countWordBitsAvx2(same, countTable, lowHalf));
+        bothTotal = _mm256_add_epi64(bothTotal, countWordBitsAvx2(both, countTable, lowHalf));
+    }
+    PairCounts result = { sumWordsAvx2(sameTotal), sumWordsAvx2(bothTotal) };
+    // Every processor with AVX2 also has the bit count instruction
+    if (index < wordCount) {
+        PairCounts tail = countPopcnt(passFirst + index, votedFirst + index, passSecond + index,
+                                      votedSecond + index, wordCount - index);
+        result._sameVotes += tail._sameVotes;
+        result._bothVoted += tail._bothVoted;
+    }
+    return result;
+}
+
+/* AVX-512 can apply any logic function of three values in one instruction. The
+    function is given as its truth table, indexed by the three input bits. Same
+    votes is first AND second AND NOT third, true only for index 110 binary */
+static const int sameVotesLogic = 0x40;
+
+// Adds the eight words of an AVX-512 register
+static inline unsigned int TARGET_AVX512_POPCNT sumWordsAvx512(__m512i value)
+{
+    uint64_t wordTotals[8];
+    _mm512_storeu_si512((void*)wordTotals, value);
+    uint64_t result = 0;
+    unsigned short wordIndex;
+    for (wordIndex = 0; wordIndex < 8; wordIndex++)
+        result += wordTotals[wordIndex];
+    return (unsigned int)result;
+}
+
+VoteDiffCounter::PairCounts TARGET_AVX512_POPCNT
+VoteDiffCounter::countAvx512(const Word* passFirst, const Word* votedFirst,
+                             const Word* passSecond, const Word* votedSecond,
+                             unsigned int wordCount)
+{
+    __m512i sameTotal = _mm512_setzero_si512();
+    __m512i bothTotal = _mm512_setzero_si512();
+    unsigned int index = 0;
+    for (; (index + 8) <= wordCount; index += 8) {
+        __m512i passA = _mm512_loadu_si512((const void*)(passFirst + index));
+        __m512i votedA = _mm512_loadu_si512((const void*)(votedFirst + index));
+        __m512i passB = _mm512_loadu_si512((const void*)(passSecond + index));
+        __m512i votedB = _mm512_loadu_si512((const void*)(votedSecond + index));
+        __m512i same = _mm512_ternarylogic_epi64(votedA, votedB, _mm512_xor_si512(passA, passB), sameVotesLogic);
+        sameTotal = _mm512_add_epi64(sameTotal, _mm512_popcnt_epi64(same));
+        bothTotal = _mm512_add_epi64(bothTotal, _mm512_popcnt_epi64(_mm512_and_si512(votedA, votedB)));
+    }
+    /* AVX-512 loads can skip words, so the tail is done with one more pass that
+        only loads the words that exist. The skipped ones read as zero */
+    if (index < wordCount) {
+        __mmask8 tailMask = (__mmask8)((1u << (wordCount - index)) - 1);
+        __m512i passA = _mm512_maskz_loadu_epi64(tailMask, passFirst + index);
+        __m512i votedA = _mm512_maskz_loadu_epi64(tailMask, votedFirst + index);
+        __m512i passB = _mm512_maskz_loadu_epi64(tailMask, passSecond + index);
+        __m512i votedB = _mm512_maskz_loadu_epi64(tailMask, votedSecond + index);
+        __m512i same = _mm512_ternarylogic_epi64(votedA, votedB, _mm512_xor_si512(passA, passB), sameVotesLogic);
+        sameTotal = _mm512_add_epi64(sameTotal, _mm512_popcnt_epi64(same));
+        bothTotal = _mm512_add_epi64(bothTotal, _mm512_popcnt_epi64(_mm512_and_si512(votedA, votedB)));
+    }
+    PairCounts result = { sumWordsAvx512(sameTotal), sumWordsAvx512(bothTotal) };
+    return result;
+}
+
+#endif // HAVE_X86_SIMD
+
+// Picks the routine. Called once, by getCountMethod()
+VoteDiffCounter::CountMethod VoteDiffCounter::selectCountMethod(void)
+{
+#ifdef HAVE_X86_SIMD
+    if (CpuFeatures::haveAvx512Popcnt())
+        return &countAvx512;
+    else if (CpuFeatures::haveAvx2() && CpuFeatures::havePopcnt())
+        return &countAvx2;
+    else if (CpuFeatures::havePopcnt())
+        return &countPopcnt;
+#endif
+    return &countScalar;
+}
+
+// Returns the best counting routine for this processor. Chosen once
+VoteDiffCounter::CountMethod VoteDiffCounter::getCountMethod(void)
+{
+    static const CountMethod method = selectCountMethod();
+    return method;
+}
+
+/* Returns the best counting routine for rows of only a few words, where the
+    setup and final sums of the vector versions cost more than they save */
+VoteDiffCounter::CountMethod VoteDiffCounter::getShortCountMethod(void)
+{
+#ifdef HAVE_X86_SIMD
+    if (CpuFeatures::havePopcnt())
+        return &countPopcnt;
+#endif
+    return &countScalar;
+}
+
+/* Returns the number of members per tile, given the bytes of data for
+    each member that the counting reads */
+unsigned short VoteDiffCounter::getTileSize(size_t bytesPerMember)
+{
+    /* Two tiles of member data should fit in the second level cache, which is
+        at least 256K on anything recent. Use half of it; the results rows and
+        everything else need room too. Very small tiles cost more in loop
+        overhead than they save */
+    const size_t tileCacheBytes = 128 * 1024;
+    const size_t minTileSize = 16;
+    const size_t maxTileSize = 1024;
+    size_t tileSize = tileCacheBytes / (2 * (bytesPerMember ? bytesPerMember : 1));
+    if (tileSize < minTileSize)
+        tileSize = minTileSize;
+    else if (tileSize > maxTileSize)
+        tileSize = maxTileSize;
+    return (unsigned short)tileSize;
+}
+
+/* Counts differences for every pair in a range of tile pairs with the given routine.
+    There is a pair of results matrices for the running total at the end of each range
+    of words; counting the whole session is a single range */
+void VoteDiffCounter::countTiles(CountMethod method, const VoteBitMatrix& passVotes,
+                                 const VoteBitMatrix& voted, unsigned int wordsPerTotal,
+                                 VoteDiffMatrix* results, VoteDiffMatrix* bothVoted, unsigned int totalCount,
+                                 size_t tileSize, TilePairList::const_iterator firstPair,
+                                 TilePairList::const_iterator lastPair)
+{
+    size_t memberCount = passVotes.getMemberCount();
+    unsigned int wordCount = passVotes.getWordsPerRow();
+
+    // Roll calls up to the end of each range. The last word may be partly filled
+    vector<int> rollCallTotals(totalCount);
+    unsigned int totalIndex;
+    for (totalIndex = 0; totalIndex < totalCount; totalIndex++)
+        rollCallTotals[totalIndex] = (int)std::min<size_t>(passVotes.getRollCallCount(),
+            (size_t)(totalIndex + 1) * wordsPerTotal * VoteBitMatrix::bitsPerWord);
+
+    /* Each range writes its own results matrix. Writing a value to every one of them
+        for each pair would scatter the writes over too many places for the cache to
+        keep up, so each range is counted across the columns of the tile in turn, with
+        the running totals so far kept for each column */
+    vector<PairCounts> columnTotals(tileSize);
+    TilePairList::const_iterator pairIndex;
+    for (pairIndex = firstPair; pairIndex != lastPair; pairIndex++) {
+        size_t rowEnd = std::min(pairIndex->_rowStart + tileSize, memberCount);
+        size_t row, column;
+        for (row = pairIndex->_rowStart; row < rowEnd; row++) {
+            const Word* passRow = passVotes.getRow(row);
+            const Word* votedRow = voted.getRow(row);
+            // Pairs with themselves and those above the diagonal are skipped
+            size_t columnEnd = std::min(pairIndex->_columnStart + tileSize, row);
+            if (columnEnd <= pairIndex->_columnStart)
+                continue;
+            std::fill(columnTotals.begin(), columnTotals.begin() + (columnEnd - pairIndex->_columnStart),
+                      PairCounts());
+            unsigned int firstWord = 0;
+            for (totalIndex = 0; totalIndex < totalCount; totalIndex++) {
+                unsigned int rangeWords = std::min(wordsPerTotal, wordCount - firstWord);
+                short* resultRow = results[totalIndex].getRow(row);
+                short* bothVotedRow = bothVoted[totalIndex].getRow(row);
+                for (column = pairIndex->_columnStart; column < columnEnd; column++) {
+                    PairCounts counts = method(passRow + firstWord, votedRow + firstWord,
+                                               passVotes.getRow(column) + firstWord,
+                                               voted.getRow(column) + firstWord, rangeWords);
+                    PairCounts& totals = columnTotals[column - pairIndex->_columnStart];
+                    totals._sameVotes += counts._sameVotes;
+                    totals._bothVoted += counts._bothVoted;
+                    resultRow[column] = (short)(rollCallTotals[totalIndex] - (int)totals._sameVotes);
+                    bothVotedRow[column] = (short)totals._bothVoted;
+                }
+                firstWord += rangeWords;
+            } // For each range of words
+        }
+    } // For each pair of tiles
+}
+
+// Counts differences for every pair with the given routine and number of threads
+void VoteDiffCounter::countWithMethod(CountMethod method, const VoteBitMatrix& passVotes,
+                                      const VoteBitMatrix& voted, unsigned int wordsPerTotal,
+                                      VoteDiffMatrix* results, VoteDiffMatrix* bothVoted,
+                                      unsigned int totalCount, unsigned int threadCount)
+{
+    size_t memberCount = passVotes.getMemberCount();
+    unsigned int totalIndex;
+    for (totalIndex = 0; totalIndex < totalCount; totalIndex++) {
+        results[totalIndex].assign(memberCount, 0);
+        bothVoted[totalIndex].assign(memberCount, 0);
+    }
+
+    /* Count the lower triangle a pair of tiles at a time. The column tile's rows
+        stay in cache while the row tile's rows stream past, and each row stays
+        in cache for every member of the column tile. List the pairs in that
+        order, along with the running total of member pairs in them */
+    const size_t tileSize = getTileSize(2 * passVotes.getWordsPerRow() * sizeof(Word));
+    TilePairList tilePairs;
+    vector<size_t> pairTotals;
+    size_t pairTotal = 0;
+    TilePair tilePair;
+    for (tilePair._columnStart = 0; tilePair._columnStart < memberCount; tilePair._columnStart += tileSize) {
+        size_t columnSize = std::min(tileSize, memberCount - tilePair._columnStart);
+        for (tilePair._rowStart = tilePair._columnStart; tilePair._rowStart < memberCount;
+             tilePair._rowStart += tileSize) {
+            size_t rowSize = std::min(tileSize, memberCount - tilePair._rowStart);
+            if (tilePair._rowStart == tilePair._columnStart)
+                pairTotal += (rowSize * (rowSize - 1)) / 2;
+            else
+                pairTotal += rowSize * columnSize;
+            tilePairs.push_back(tilePair);
+            pairTotals.push_back(pairTotal);
+        }
+    }
+
+    // No point in a thread with nothing to count
+    if (threadCount > tilePairs.size())
+        threadCount = tilePairs.size();
+    if (threadCount <= 1)
+        countTiles(method, passVotes, voted, wordsPerTotal, results, bothVoted, totalCount,
+                   tileSize, tilePairs.begin(), tilePairs.end());
+    else {
+        /* Give each thread a consecutive range of tile pairs holding about the same
+            number of member pairs. This thread counts the last range itself */
+        vector<std::thread> workers;
+        TilePairList::const_iterator rangeStart = tilePairs.begin();
+        unsigned int threadIndex;
+        for (threadIndex = 0; (threadIndex + 1) < threadCount; threadIndex++) {
+            size_t rangeTotal = (pairTotal * (threadIndex + 1)) / threadCount;
+            TilePairList::const_iterator rangeEnd = tilePairs.begin() +
+                (std::lower_bound(pairTotals.begin(), pairTotals.end(), rangeTotal) - pairTotals.begin());
+            if (rangeEnd < rangeStart)
+                rangeEnd = rangeStart;
+            workers.push_back(std::thread(&countTiles, method, std::cref(passVotes), std::cref(voted),
+                                          wordsPerTotal, results, bothVoted, totalCount, tileSize,
+                                          rangeStart, rangeEnd));
+            rangeStart = rangeEnd;
+        }
+        countTiles(method, passVotes, voted, wordsPerTotal, results, bothVoted, totalCount,
+                   tileSize, rangeStart, tilePairs.end());
+        for (threadIndex = 0; threadIndex < workers.size(); threadIndex++)
+            workers[threadIndex].join();
+    } // Multiple threads
+}
+
+/* Counts the roll calls where each pair of Congresspeople voted differently,
+    or either did not vote, and the roll calls where both voted. Replaces the
+    contents of both results. The work is
+    split between the given number of threads; the results do not depend on
+    the count. Throws out_of_range if the two bit matrices don't match */
+void VoteDiffCounter::countDifferences(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                                       VoteDiffMatrix& results, VoteDiffMatrix& bothVoted,
+                                       unsigned int threadCount)
+{
+    if ((passVotes.getMemberCount() != voted.getMemberCount()) ||
+        (passVotes.getRollCallCount() != voted.getRollCallCount()))
+        throw std::out_of_range("VoteDiffCounter vote bit matrices differ in size");
+    countWithMethod(getCountMethod(), passVotes, voted, passVotes.getWordsPerRow(),
+                    &results, &bothVoted, 1, threadCount);
+}
+
+/* Counts the same as countDifferences() for every roll call up to the end of each
+    range of the given number of words of roll calls, giving running totals through
+    the session. Throws out_of_range if the two bit matrices don't match */
+void VoteDiffCounter::countRunningTotals(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                                         unsigned int wordsPerTotal, vector<VoteDiffMatrix>& results,
+                                         vector<VoteDiffMatrix>& bothVoted, unsigned int threadCount)
+{
+    if ((passVotes.getMemberCount() != voted.getMemberCount()) ||
+        (passVotes.getRollCallCount() != voted.getRollCallCount()))
+        throw std::out_of_range("VoteDiffCounter vote bit matrices differ in size");
+    if (wordsPerTotal < 1)
+        wordsPerTotal = 1;
+    unsigned int totalCount = (passVotes.getWordsPerRow() + wordsPerTotal - 1) / wordsPerTotal;
+    results.resize(totalCount);
+    bothVoted.resize(totalCount);
+    /* Each pair is compared a range at a time. The vector versions work on 4 or 8
+        words at once, so shorter ranges are faster a word at a time */
+    const unsigned int shortRangeWords = 8;
+    CountMethod method = (wordsPerTotal < shortRangeWords) ? getShortCountMethod() : getCountMethod();
+    if (totalCount > 0)
+        countWithMethod(method, passVotes, voted, wordsPerTotal,
+                        &results[0], &bothVoted[0], totalCount, threadCount);
+}
+
+/* Counts the roll calls where one pair of Congresspeople cast the same vote, and
+    where both voted, within a range of words of roll calls */
+void VoteDiffCounter::countPair(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                                unsigned short first, unsigned short second,
+                                unsigned int firstWord, unsigned int wordCount,
+                                unsigned int& sameVotes, unsigned int& bothVoted)
+{
+    // Same limit as running totals, for the same reason
+    const unsigned int shortRangeWords = 8;
+    CountMethod method = (wordCount < shortRangeWords) ? getShortCountMethod() : getCountMethod();
+    PairCounts counts = method(passVotes.getRow(first) + firstWord, voted.getRow(first) + firstWord,
+                               passVotes.getRow(second) + firstWord, voted.getRow(second) + firstWord,
+                               wordCount);
+    sameVotes = counts._sameVotes;
+    bothVoted = counts._bothVoted;
+}
+
+/* Times every counting version available on this processor on the given
+    votes, and checks that they agree. If given more than one thread, also
+    times the best version with each thread count up to it. Results are
+    written to standard error */
+void VoteDiffCounter::debugBenchmark(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                                     unsigned int iterations, unsigned int threadCount)
+{
+    vector<std::pair<string, CountMethod> > methods;
+    methods.push_back(std::make_pair(string("scalar"), &countScalar));
+#ifdef HAVE_X86_SIMD
+    if (CpuFeatures::havePopcnt())
+        methods.push_back(std::make_pair(string("POPCNT"), &countPopcnt));
+    if (CpuFeatures::haveAvx2() && CpuFeatures::havePopcnt())
+        methods.push_back(std::make_pair(string("AVX2"), &countAvx2));
+    if (CpuFeatures::haveAvx512Popcnt())
+        methods.push_back(std::make_pair(string("AVX-512"), &countAvx512));
+#endif
+
+    cerr << passVotes.getMemberCount() << " members, " << passVotes.getRollCallCount()
+         << " roll calls" << endl;
+    typedef std::chrono::steady_clock Clock;
+    VoteDiffMatrix scalarResults, scalarBothVoted;
+    double scalarTime = 0.0;
+    unsigned short methodIndex;
+    for (methodIndex = 0; methodIndex < methods.size(); methodIndex++) {
+        VoteDiffMatrix results, bothVoted;
+        Clock::time_point start = Clock::now();
+        unsigned int pass;
+        for (pass = 0; pass < iterations; pass++)
+            countWithMethod(methods[methodIndex].second, passVotes, voted, passVotes.getWordsPerRow(),
+                            &results, &bothVoted, 1, 1);
+        double methodTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+        cerr << methods[methodIndex].first << ": " << methodTime << " ms per session";
+        if (methodIndex == 0) {
+            scalarResults = results;
+            scalarBothVoted = bothVoted;
+            scalarTime = methodTime;
+        }
+        else {
+            cerr << ", " << (scalarTime / methodTime) << "x scalar speed";
+            if ((results != scalarResults) || (bothVoted != scalarBothVoted))
+                cerr << " WARNING: results differ from scalar";
+        }
+        cerr << endl;
+    } // For each method
+
+    double singleTime = 0.0;
+    unsigned int threads;
+    for (threads = 1; (threadCount > 1) && (threads <= threadCount); threads++) {
+        VoteDiffMatrix results, bothVoted;
+        Clock::time_point start = Clock::now();
+        unsigned int pass;
+        for (pass = 0; pass < iterations; pass++)
+            countWithMethod(getCountMethod(), passVotes, voted, passVotes.getWordsPerRow(),
+                            &results, &bothVoted, 1, threads);
+        double threadTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+        if (threads == 1)
+            singleTime = threadTime;
+        cerr << threads << " threads: " << threadTime << " ms per session, "
+             << (singleTime / threadTime) << "x single thread speed";
+        if ((results != scalarResults) || (bothVoted != scalarBothVoted))
+            cerr << " WARNING: results differ from scalar";
+        cerr << endl;
+    } // For each thread count
+}
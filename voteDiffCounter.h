@@ -0,0 +1,172 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class counts the vote differences between every pair of Congresspeople
+    from the vote bits of an entire session in one pass. Counting them a block
+    of roll calls at a time means a pass over every pair for each block; with
+    the whole session in memory, each pair is visited once and its rows are
+    compared a full word (or vector register) at a time.
+
+    Two members have the same vote on a roll call when both voted and their
+    pass bits match. Everything else is a difference, so the count of
+    differences is the number of roll calls less the count of matches. Counting
+    matches needs no masking, since the voted bits past the last roll call are
+    always zero.
+
+    Other measures of similarity need the number of roll calls where both
+    members voted. Counting it takes one more bit count per word while the
+    rows are already loaded, so it is counted in the same pass.
+
+    With thousands of members, the rows of all of them don't fit in the
+    processor cache, so visiting the pairs row by row reads every row from
+    memory again for each member. Instead the members are split into tiles
+    small enough that two tiles of rows fit in cache, and the pairs are counted
+    a tile against a tile. The results only hold the lower triangle, so each
+    pair is counted once.
+
+    The counts can also be running totals through the session, one set at the
+    end of every few words of roll calls. Each pair is still visited once, with
+    its words compared a range at a time.
+
+    The pairs of tiles can be split between threads. Each pair of tiles writes
+    its own part of the results, so the threads need no locking, and the
+    results are the same for any number of threads. The pairs are split into
+    consecutive ranges with about the same number of member pairs in each;
+    tiles on the diagonal hold half as many as the others.
+
+    Versions exist for AVX-512 (with its bit count instruction), AVX2, the
+    single word bit count instruction, and plain C++. The best one the processor
+    supports is chosen the first time differences are counted */
+#ifndef VOTE_DIFF_COUNTER_H_INCLUDED
+#define VOTE_DIFF_COUNTER_H_INCLUDED
+
+#include"cpuFeatures.h" // Defines HAVE_X86_SIMD
+#include"voteBitMatrix.h"
+#include"voteDiffMatrix.h"
+
+class VoteDiffCounter
+{
+public:
+    /* Counts the roll calls where each pair of Congresspeople voted differently,
+        or either did not vote, and the roll calls where both voted. Replaces the
+        contents of both results. The work is split between the given number of
+        threads; the results do not depend on the count. Throws out_of_range if
+        the two bit matrices don't match */
+    static void countDifferences(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                                 VoteDiffMatrix& results, VoteDiffMatrix& bothVoted,
+                                 unsigned int threadCount = 1);
+
+    /* Counts the same as countDifferences() for every roll call up to the end of each
+        range of the given number of words of roll calls, giving running totals through
+        the session. The last range ends at the end of the session. Each pair is visited
+        once, so this costs little more than counting the whole session. Replaces the
+        contents of both results, which get one matrix per range. Throws out_of_range if
+        the two bit matrices don't match */
+    static void countRunningTotals(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                                   unsigned int wordsPerTotal, vector<VoteDiffMatrix>& results,
+                                   vector<VoteDiffMatrix>& bothVoted, unsigned int threadCount = 1);
+
+    /* Counts the roll calls where one pair of Congresspeople cast the same vote, and
+        where both voted, within a range of words of roll calls. For code that only
+        needs a few of the pairs, such as clustering sets of members too large for a
+        matrix of every pair. Indexes are not checked */
+    static void countPair(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                          unsigned short first, unsigned short second,
+                          unsigned int firstWord, unsigned int wordCount,
+                          unsigned int& sameVotes, unsigned int& bothVoted);
+
+    /* Returns the number of members per tile, given the bytes of data for
+        each member that the counting reads */
+    static unsigned short getTileSize(size_t bytesPerMember);
+
+    /* Times every counting version available on this processor on the given
+        votes, and checks that they agree. If given more than one thread, also
+        times the best version with each thread count up to it. Results are
+        written to standard error */
+    static void debugBenchmark(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                               unsigned int iterations = 20, unsigned int threadCount = 1);
+
+private:
+    typedef VoteBitMatrix::Word Word;
+
+    // Roll calls where two members cast the same vote, and where both voted
+    struct PairCounts {
+        unsigned int _sameVotes;
+        unsigned int _bothVoted;
+    };
+
+    // Counts the roll calls for two members, given their rows
+    typedef PairCounts (*CountMethod)(const Word* passFirst, const Word* votedFirst,
+                                      const Word* passSecond, const Word* votedSecond,
+                                      unsigned int wordCount);
+
+    // The counting routines
+    static PairCounts countScalar(const Word* passFirst, const Word* votedFirst,
+                                  const Word* passSecond, const Word* votedSecond,
+                                  unsigned int wordCount);
+#ifdef HAVE_X86_SIMD
+    static PairCounts countPopcnt(const Word* passFirst, const Word* votedFirst,
+                                  const Word* passSecond, const Word* votedSecond,
+                                  unsigned int wordCount);
+    static PairCounts countAvx2(const Word* passFirst, const Word* votedFirst,
+                                const Word* passSecond, const Word* votedSecond,
+                                unsigned int wordCount);
+    static PairCounts countAvx512(const Word* passFirst, const Word* votedFirst,
+                                  const Word* passSecond, const Word* votedSecond,
+                                  unsigned int wordCount);
+#endif
+
+    /* A pair of tiles of members, given by the first member of each. The row
+        tile is never before the column tile */
+    struct TilePair {
+        size_t _rowStart;
+        size_t _columnStart;
+    };
+    typedef vector<TilePair> TilePairList;
+
+    /* Counts differences for every pair in a range of tile pairs with the given routine.
+        There is a pair of results matrices for the running total at the end of each range
+        of words; counting the whole session is a single range */
+    static void countTiles(CountMethod method, const VoteBitMatrix& passVotes,
+                           const VoteBitMatrix& voted, unsigned int wordsPerTotal,
+                           VoteDiffMatrix* results, VoteDiffMatrix* bothVoted, unsigned int totalCount,
+                           size_t tileSize, TilePairList::const_iterator firstPair,
+                           TilePairList::const_iterator lastPair);
+
+    // Counts differences for every pair with the given routine and number of threads
+    static void countWithMethod(CountMethod method, const VoteBitMatrix& passVotes,
+                                const VoteBitMatrix& voted, unsigned int wordsPerTotal,
+                                VoteDiffMatrix* results, VoteDiffMatrix* bothVoted,
+                                unsigned int totalCount, unsigned int threadCount);
+
+    // Returns the best counting routine for this processor. Chosen once
+    static CountMethod getCountMethod(void);
+
+    // Picks the routine. Called once, by getCountMethod()
+    static CountMethod selectCountMethod(void);
+
+    /* Returns the best counting routine for rows of only a few words, where the
+        setup and final sums of the vector versions cost more than they save */
+    static CountMethod getShortCountMethod(void);
+};
+
+#endif // VOTE_DIFF_COUNTER_H_INCLUDED
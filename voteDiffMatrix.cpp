@@ -0,0 +1,46 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+
+// Packed triangular storage of vote differences between pairs of members
+#include<vector>
+#include"voteDiffMatrix.h"
+
+using std::vector;
+
+VoteDiffMatrix::VoteDiffMatrix() : _values()
+{
+    _memberCount = 0;
+}
+
+// Creates a matrix for the given number of members, with every value set to the one given
+VoteDiffMatrix::VoteDiffMatrix(size_t memberCount, short value) : _values()
+{
+    assign(memberCount, value);
+}
+
+// Clears the matrix and sizes it for the given number of members, with every value set
+void VoteDiffMatrix::assign(size_t memberCount, short value)
+{
+    _memberCount = memberCount;
+    _values.assign(getRowOffset(memberCount), value);
+}
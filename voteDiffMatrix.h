@@ -0,0 +1,168 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class holds a value for every pair of Congresspeople, or of the groups
+    they are clustered into: the number of roll calls where they voted
+    differently. The values are symmetric, so only the lower triangle is kept,
+    diagonal included, packed row after row in a single allocation. Row N holds
+    the values for columns 0 through N, and starts right after row N-1.
+
+    Lookups with get() and at() take the pair in either order. Loops over every
+    pair should use getRow() instead, and only visit columns up to the row
+    number; it avoids the check and swap of the indexes on every value */
+#ifndef VOTE_DIFF_MATRIX_H_INCLUDED
+#define VOTE_DIFF_MATRIX_H_INCLUDED
+
+#include<vector>
+#include<cstddef>
+#include<stdexcept>
+
+using std::vector;
+
+class VoteDiffMatrix
+{
+public:
+    VoteDiffMatrix();
+
+    // Creates a matrix for the given number of members, with every value set to the one given
+    explicit VoteDiffMatrix(size_t memberCount, short value = 0);
+
+    // Clears the matrix and sizes it for the given number of members, with every value set
+    void assign(size_t memberCount, short value = 0);
+
+    // Number of members; the matrix is this many rows and columns
+    size_t size(void) const;
+    bool empty(void) const;
+
+    // Gets or sets the value for a pair of members, in either order. Indexes are not checked
+    short get(size_t first, size_t second) const;
+    void set(size_t first, size_t second, short value);
+
+    // As above, but throws out_of_range if either index is past the end
+    short& at(size_t first, size_t second);
+    short at(size_t first, size_t second) const;
+
+    /* Direct access to one row. Only columns up to the row number are valid.
+        Indexes are not checked */
+    const short* getRow(size_t row) const;
+    short* getRow(size_t row);
+
+    // Direct access to every value at once, for operations that treat them all alike
+    size_t getValueCount(void) const;
+    const short* getValues(void) const;
+    short* getValues(void);
+
+    bool operator==(const VoteDiffMatrix& other) const;
+    bool operator!=(const VoteDiffMatrix& other) const;
+
+private:
+    vector<short> _values;
+    size_t _memberCount;
+
+    // Location of the first value of a row
+    static size_t getRowOffset(size_t row);
+};
+
+inline size_t VoteDiffMatrix::getRowOffset(size_t row)
+{
+    return (row * (row + 1)) / 2;
+}
+
+inline size_t VoteDiffMatrix::size(void) const
+{
+    return _memberCount;
+}
+
+inline bool VoteDiffMatrix::empty(void) const
+{
+    return _memberCount == 0;
+}
+
+inline short VoteDiffMatrix::get(size_t first, size_t second) const
+{
+    if (first < second)
+        return _values[getRowOffset(second) + first];
+    else
+        return _values[getRowOffset(first) + second];
+}
+
+inline void VoteDiffMatrix::set(size_t first, size_t second, short value)
+{
+    if (first < second)
+        _values[getRowOffset(second) + first] = value;
+    else
+        _values[getRowOffset(first) + second] = value;
+}
+
+inline short& VoteDiffMatrix::at(size_t first, size_t second)
+{
+    if ((first >= _memberCount) || (second >= _memberCount))
+        throw std::out_of_range("VoteDiffMatrix index past the end");
+    if (first < second)
+        return _values[getRowOffset(second) + first];
+    else
+        return _values[getRowOffset(first) + second];
+}
+
+inline short VoteDiffMatrix::at(size_t first, size_t second) const
+{
+    if ((first >= _memberCount) || (second >= _memberCount))
+        throw std::out_of_range("VoteDiffMatrix index past the end");
+    return get(first, second);
+}
+
+inline const short* VoteDiffMatrix::getRow(size_t row) const
+{
+    return _values.data() + getRowOffset(row);
+}
+
+inline short* VoteDiffMatrix::getRow(size_t row)
+{
+    return _values.data() + getRowOffset(row);
+}
+
+inline size_t VoteDiffMatrix::getValueCount(void) const
+{
+    return _values.size();
+}
+
+inline const short* VoteDiffMatrix::getValues(void) const
+{
+    return _values.data();
+}
+
+inline short* VoteDiffMatrix::getValues(void)
+{
+    return _values.data();
+}
+
+inline bool VoteDiffMatrix::operator==(const VoteDiffMatrix& other) const
+{
+    return (_memberCount == other._memberCount) && (_values == other._values);
+}
+
+inline bool VoteDiffMatrix::operator!=(const VoteDiffMatrix& other) const
+{
+    return !(*this == other);
+}
+
+#endif // VOTE_DIFF_MATRIX_H_INCLUDED
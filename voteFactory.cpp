@@ -28,25 +28,46 @@
 #include<climits>
 #include<iomanip>
 #include<sstream>
+#include<thread>
+#include<chrono>
+#include<algorithm>
+#include<numeric>
 #include"congressData.h"
 #include"voteFactory.h"
+#include"voteDiffCounter.h"
+#include"voteWindows.h"
 #include"rollCall.h"
+#include"rollCallManifest.h"
+
+#ifdef _WIN32
+#define NOMINMAX // Otherwise it breaks std::min
+#include<windows.h>
+#else
+#include<unistd.h>
+#endif
 
-// Number of consecutive bad vote files that will make this class quit
-#define FAILURES_FOR_QUIT 5
 #define SCREEN_WIDTH 80
 
 using std::bitset;
 using std::vector;
+using std::thread;
+using std::exception_ptr;
 using std::cerr;
 using std::endl;
 using std::ios_base;
 using std::stringstream;
 
 /* Given how congresspeople voted on bills, finds the number of differences in their
-    votes and updates the results matrix */
-void VoteFactory::convVoteResultToDiff(VoteResults& passVotes, VoteResults& voted, VoteDiffMatrix& results)
+    votes and the number of bills both voted on, and updates the results matrices. Only
+    the vote positions set in the mask are used */
+template<size_t blockSize>
+void VoteFactory::convVoteResultToDiff(const vector<bitset<blockSize> >& passVotes,
+                                       const vector<bitset<blockSize> >& voted,
+                                       const bitset<blockSize>& usedVotes, VoteDiffMatrix& results,
+                                       VoteDiffMatrix& bothVoted)
 {
+    typedef bitset<blockSize> Votes;
+
     /* The definition of two congresspersons having different votes on a given roll call:
         (A not voted) OR (B not voted) OR (A vote XOR B vote). Declarinng a mismatch if
         either did not vote is required to satisfy the triangle principle so distance based
@@ -55,152 +76,540 @@ void VoteFactory::convVoteResultToDiff(VoteResults& passVotes, VoteResults& vote
         as physical spacings on a map, the three congresspeople will form a traingle) */
 
     /* The vote results come in with bits set for when people voted. Need to know
-        when they did NOT vote, so flip them */
+        when they did NOT vote, so flip them. The last block of a year is usually
+        not full; positions past the last roll call are not votes, and must not
+        count as everyone not voting, so mask them off */
     // NASTY HACK: Avoid undefined behavior if results not set up correctly
     if (!results.size())
         return;
-    VoteResults notVoted(voted);
-    VoteResults::iterator tempIndex;
-    for (tempIndex = notVoted.begin(); tempIndex != notVoted.end(); tempIndex++)
+    vector<Votes> notVoted(voted);
+    typename vector<Votes>::iterator tempIndex;
+    for (tempIndex = notVoted.begin(); tempIndex != notVoted.end(); tempIndex++) {
         tempIndex->flip();
-    unsigned short first, second;
-    // The last congressperson has nobody to compare with, so ignore them with the '-1'
-    for (first = 0; first < results.size() - 1; first++) {
-        for (second = first + 1; second < results.size(); second++) {
-            Votes temp(passVotes[first]);
-            temp ^= passVotes[second];
-            temp |= notVoted[first];
-            temp |= notVoted[second];
-            results.at(first).at(second) += temp.count();
-            results.at(second).at(first) += temp.count();
-        } // Inner congressperson loop
-    } // Outer congressperson loop
-}
-
-/* Finds the vote differences for a single year and adds them to the results.
-    This method is private because it depends on consistency conditions enforced elsewhere */
-void VoteFactory::getVoteDiff(VoteDiffMatrix& results, short& billCount,
-                              const CongressData& congress, short year)
+        *tempIndex &= usedVotes;
+    }
+
+    /* Work on tiles of members small enough to stay in cache. See VoteDiffCounter
+        for details; this is the same scheme */
+    const size_t tileSize = VoteDiffCounter::getTileSize(2 * sizeof(Votes));
+    size_t memberCount = results.size();
+    size_t rowStart, columnStart;
+    for (columnStart = 0; columnStart < memberCount; columnStart += tileSize) {
+        for (rowStart = columnStart; rowStart < memberCount; rowStart += tileSize) {
+            size_t rowEnd = std::min(rowStart + tileSize, memberCount);
+            size_t row, column;
+            for (row = rowStart; row < rowEnd; row++) {
+                const Votes& rowPass = passVotes[row];
+                const Votes& rowNotVoted = notVoted[row];
+                const Votes& rowVoted = voted[row];
+                short* resultRow = results.getRow(row);
+                short* bothVotedRow = bothVoted.getRow(row);
+                // Pairs with themselves and those above the diagonal are skipped
+                size_t columnEnd = std::min(columnStart + tileSize, row);
+                for (column = columnStart; column < columnEnd; column++) {
+                    resultRow[column] += ((rowPass ^ passVotes[column]) | rowNotVoted | notVoted[column]).count();
+                    // Bits past the end of the block are never set, so no mask is needed
+                    bothVotedRow[column] += (rowVoted & voted[column]).count();
+                }
+            }
+        } // For each tile of rows
+    } // For each tile of columns
+}
+
+/* Reads one roll call file and sets its votes at the given offset in the block. Returns
+    true if the file was an up or down vote. The flag is set if any votes were recorded */
+template<size_t blockSize>
+bool VoteFactory::loadRollCall(RollCall& rollCall, const CongressData& congress,
+                               const RollCallManifest& rollCalls, short year, int rollCallNo,
+                               unsigned short blockOffset, vector<bitset<blockSize> >& passVotes,
+                               vector<bitset<blockSize> >& voted, bool& haveVotes)
 {
-    RollCall rollCall;
-//    rollCall.setTrace();
+    haveVotes = false; // None read yet
+    rollCall.open(rollCalls, year, rollCallNo);
+    if (!rollCall.haveVotes())
+        // Not finding any votes implies a bad file
+        return false;
 
-    Votes resetVotes; // Vote block with all votes false
-    VoteResults passVotes(congress.getSize(), resetVotes);
-    VoteResults voted(congress.getSize(), resetVotes);
+    RollCall::VoteRecord newVote;
+    while (rollCall.haveVotes()) {
+        newVote = rollCall.getNextVote();
+        unsigned short congressIndex = congress.getIndexNo(newVote.first);
+        if (congressIndex == SHRT_MAX) {
+            // Not found. people.xml configured incorrectly
+            // NOTE: Written in one piece so messages from different threads don't mix
+            stringstream message;
+            message << "WARNING: people.xml corrupt. Congressperson reference number "
+                << newVote.first << " not defined but in rollcall " << rollCallNo
+                << " for year " << year << endl;
+            cerr << message.str();
+        }
+        else {
+            if (newVote.second)
+                passVotes.at(congressIndex).set(blockOffset);
+            voted.at(congressIndex).set(blockOffset);
+            haveVotes = true;
+        } // Congressperson valid
+    } // Votes to process
+    return true;
+}
+
+/* Adds the first voteCount roll calls of a block to the session results: they are
+    appended to the bit matrices, and their differences are counted if wanted */
+template<size_t blockSize>
+void VoteFactory::saveVoteBlock(const vector<bitset<blockSize> >& passVotes,
+                                const vector<bitset<blockSize> >& voted, unsigned short voteCount,
+                                bool countDifferences, SessionVotes& votes)
+{
+    unsigned short blockOffset;
+    if (countDifferences) {
+        bitset<blockSize> usedVotes;
+        for (blockOffset = 0; blockOffset < voteCount; blockOffset++)
+            usedVotes.set(blockOffset);
+        convVoteResultToDiff(passVotes, voted, usedVotes, votes._differences, votes._bothVoted);
+    }
+
+    for (blockOffset = 0; blockOffset < voteCount; blockOffset++) {
+        unsigned int rollCallIndex = votes._passVotes.addRollCall();
+        votes._voted.addRollCall();
+        unsigned short member;
+        for (member = 0; member < passVotes.size(); member++) {
+            if (passVotes[member].test(blockOffset))
+                votes._passVotes.set(member, rollCallIndex);
+            if (voted[member].test(blockOffset))
+                votes._voted.set(member, rollCallIndex);
+        }
+    } // For each roll call in the block
+}
+
+/* Finds the vote differences for the given roll calls of a single year and adds them to the
+    results. Returns the number of roll calls that contributed votes. This method is private
+    because it depends on consistency conditions enforced elsewhere */
+int VoteFactory::getVoteDiff(SessionVotes& votes, const CongressData& congress,
+                             const RollCallManifest& rollCalls, short year,
+                             const vector<int>& rollCallNos, unsigned int workerCount,
+                             DiffMethod method)
+{
+    // No point in a thread with nothing to read
+    if (workerCount > rollCallNos.size())
+        workerCount = rollCallNos.size();
 
-    int rollCallNo = 1;
-    bool haveFileToProcess = false;
-    int failureCount = 0;
-    bool haveVotes = false;
     int successCount = 0;
-    while (failureCount < FAILURES_FOR_QUIT) {
-        /* If this roll call is the start of a new block, and the previous one
-            read any votes, process it
-            SUBTLE NOTE: Don't bother checking for the first block, since no votes
-            have been read! */
-        int rollBlockOffset = (rollCallNo - 1) % ROLL_CALL_BLOCK_SIZE;
-        if ((rollBlockOffset == 0) && haveFileToProcess) {
-            convVoteResultToDiff(passVotes, voted, results);
-            // Clear the block for next pass
-            passVotes.assign(congress.getSize(), resetVotes);
-            voted.assign(congress.getSize(), resetVotes);
-            haveFileToProcess = false;
+    if (workerCount <= 1)
+        successCount = readRollCalls(votes, congress, rollCalls, year, rollCallNos.begin(), rollCallNos.end(),
+                                     method);
+    else {
+        /* Split the roll calls into one consecutive range per worker. Each worker
+            finds the votes for its range in its own results, and they are added
+            together afterward in worker order. The differences are counts, and the
+            roll calls end up in file order, so this gives the same answer as reading
+            them all in one thread */
+        vector<SessionVotes> workerVotes(workerCount);
+        vector<int> workerSuccessCounts(workerCount, 0);
+        vector<exception_ptr> workerErrors(workerCount);
+        vector<thread> workers;
+        unsigned int workerIndex;
+        for (workerIndex = 0; workerIndex < workerCount; workerIndex++) {
+            size_t firstIndex = (rollCallNos.size() * workerIndex) / workerCount;
+            size_t lastIndex = (rollCallNos.size() * (workerIndex + 1)) / workerCount;
+            SessionVotes& workerResult = workerVotes[workerIndex];
+            // Whole session differences are counted later, so workers don't need a matrix
+            if (method != diffWholeSession) {
+                workerResult._differences.assign(congress.getSize(), 0);
+                workerResult._bothVoted.assign(congress.getSize(), 0);
+            }
+            workerResult._billCount = 0;
+            workerResult._passVotes.reset(congress.getSize(), lastIndex - firstIndex);
+            workerResult._voted.reset(congress.getSize(), lastIndex - firstIndex);
+            workers.push_back(thread(&readRollCallsWorker, std::ref(workerResult),
+                                     std::ref(workerSuccessCounts[workerIndex]),
+                                     std::cref(congress), std::cref(rollCalls), year,
+                                     rollCallNos.begin() + firstIndex, rollCallNos.begin() + lastIndex,
+                                     method, std::ref(workerErrors[workerIndex])));
         }
-        rollCall.open(year, rollCallNo);
-        if (!rollCall.haveVotes())
-            // Not finding any votes implies a bad file
-            failureCount++;
-        else {
-            // Found a good one, so clear failure count
-            failureCount = 0;
-            haveFileToProcess = true;
-            haveVotes = false; // None read yet
-            billCount++;
-            RollCall::VoteRecord newVote;
-            while (rollCall.haveVotes()) {
-                newVote = rollCall.getNextVote();
-                unsigned short congressIndex = congress.getIndexNo(newVote.first);
-                if (congressIndex == SHRT_MAX) {
-                    // Not found. people.xml configured incorrectly
-                    cerr << "WARNING: people.xml corrupt. Congressperson reference number "
-                        << newVote.first << " not defined but in rollcall " << rollCallNo
-                        << " for year " << year << endl;
+        for (workerIndex = 0; workerIndex < workerCount; workerIndex++)
+            workers[workerIndex].join();
+        for (workerIndex = 0; workerIndex < workerCount; workerIndex++)
+            if (workerErrors[workerIndex])
+                std::rethrow_exception(workerErrors[workerIndex]);
+
+        // Combine in worker order
+        for (workerIndex = 0; workerIndex < workerCount; workerIndex++) {
+            const SessionVotes& workerResult = workerVotes[workerIndex];
+            if (method != diffWholeSession) {
+                short* differences = votes._differences.getValues();
+                const short* workerDifferences = workerResult._differences.getValues();
+                short* bothVoted = votes._bothVoted.getValues();
+                const short* workerBothVoted = workerResult._bothVoted.getValues();
+                size_t valueIndex;
+                for (valueIndex = 0; valueIndex < votes._differences.getValueCount(); valueIndex++) {
+                    differences[valueIndex] += workerDifferences[valueIndex];
+                    bothVoted[valueIndex] += workerBothVoted[valueIndex];
                 }
-                else {
-                    if (newVote.second)
-                        passVotes.at(congressIndex).set(rollBlockOffset);
-                    voted.at(congressIndex).set(rollBlockOffset);
-                    haveVotes = true;
-                } // Congressperson valid
-            } // Votes to process
+            }
+            votes._billCount += workerResult._billCount;
+            votes._passVotes.append(workerResult._passVotes);
+            votes._voted.append(workerResult._voted);
+            successCount += workerSuccessCounts[workerIndex];
+        }
+    } // Multiple workers
+    return successCount;
+}
+
+/* Reads a range of roll calls from a year, adding them to the results. Returns the
+    number of roll calls that contributed votes. Calls readRollCallBlocks() with the
+    block width for the method */
+int VoteFactory::readRollCalls(SessionVotes& votes, const CongressData& congress,
+                               const RollCallManifest& rollCalls, short year,
+                               vector<int>::const_iterator first, vector<int>::const_iterator last,
+                               DiffMethod method)
+{
+    switch (method) {
+    case diffByBlock64:
+        return readRollCallBlocks<64>(votes, congress, rollCalls, year, first, last, true);
+    case diffByBlock256:
+        return readRollCallBlocks<256>(votes, congress, rollCalls, year, first, last, true);
+    case diffByBlock512:
+        return readRollCallBlocks<512>(votes, congress, rollCalls, year, first, last, true);
+    default:
+        /* The whole session is counted after reading, so the blocks only collect
+            the bits. A word at a time is plenty */
+        return readRollCallBlocks<64>(votes, congress, rollCalls, year, first, last, false);
+    }
+}
+
+// Reads a range of roll calls a block at a time. Returns the same as readRollCalls()
+template<size_t blockSize>
+int VoteFactory::readRollCallBlocks(SessionVotes& votes, const CongressData& congress,
+                                    const RollCallManifest& rollCalls, short year,
+                                    vector<int>::const_iterator first, vector<int>::const_iterator last,
+                                    bool countDifferences)
+{
+    RollCall rollCall;
+//    rollCall.setTrace();
+
+    bitset<blockSize> resetVotes; // Vote block with all votes false
+    vector<bitset<blockSize> > passVotes(congress.getSize(), resetVotes);
+    vector<bitset<blockSize> > voted(congress.getSize(), resetVotes);
+
+    /* Only roll calls that are up or down votes take a position in the block.
+        Anything else leaves no votes behind, so the next file reuses the spot */
+    unsigned short rollBlockOffset = 0;
+    int successCount = 0;
+    vector<int>::const_iterator rollCallIndex;
+    for (rollCallIndex = first; rollCallIndex != last; rollCallIndex++) {
+        bool haveVotes;
+        if (loadRollCall(rollCall, congress, rollCalls, year, *rollCallIndex, rollBlockOffset,
+                         passVotes, voted, haveVotes)) {
+            votes._billCount++;
             // If read votes out of the file, increment the success count
-            /* TRICKY NOTE: Success plus failure may be less than the total files processed.
-                Files that contain no processed voted don't count in either category */
+            /* TRICKY NOTE: Files that contain no processed votes still count as bills,
+                they just don't show the data exists */
             if (haveVotes)
                 successCount++;
+            rollBlockOffset++;
+            if (rollBlockOffset == blockSize) {
+                saveVoteBlock(passVotes, voted, rollBlockOffset, countDifferences, votes);
+                // Clear the block for next pass
+                passVotes.assign(congress.getSize(), resetVotes);
+                voted.assign(congress.getSize(), resetVotes);
+                rollBlockOffset = 0;
+            }
         } // Roll call file is valid
-        rollCallNo++;
-    } // While files to process and under error limi
+    } // For each roll call in the range
 
     // Process any unfinished block here
-    if (haveFileToProcess)
-        convVoteResultToDiff(passVotes, voted, results);
+    if (rollBlockOffset > 0)
+        saveVoteBlock(passVotes, voted, rollBlockOffset, countDifferences, votes);
+    return successCount;
+}
+
+// Worker thread body. Calls readRollCalls() and saves any exception for the creating thread
+void VoteFactory::readRollCallsWorker(SessionVotes& votes, int& successCount,
+                                      const CongressData& congress,
+                                      const RollCallManifest& rollCalls, short year,
+                                      vector<int>::const_iterator first, vector<int>::const_iterator last,
+                                      DiffMethod method, exception_ptr& error)
+{
+    try {
+        successCount = readRollCalls(votes, congress, rollCalls, year, first, last, method);
+    }
+    catch (...) {
+        // Threads can't throw to their creator. Save it for the creator to rethrow
+        error = std::current_exception();
+    }
+}
+
+/* Reads the votes for the roll calls in the manifest, without normalizing the
+    differences. Threading is the same as getVoteMatrix(). A year with no files is
+    skipped, as for a session in progress */
+void VoteFactory::readVotes(SessionVotes& votes, const CongressData& congress,
+                            const RollCallManifest& rollCalls, unsigned int workerCount,
+                            DiffMethod method)
+{
+    // Insure previous results do not carry over
+    votes._differences.assign(congress.getSize(), 0);
+    votes._bothVoted.assign(congress.getSize(), 0);
+    votes._billCount = 0;
+    // The manifest gives the most roll calls there can be, so the bits never need to move
+    votes._passVotes.reset(congress.getSize(), rollCalls.getRollCallCount());
+    votes._voted.reset(congress.getSize(), rollCalls.getRollCallCount());
+    method = resolveDiffMethod(method, votes, rollCalls.getRollCallCount(), workerCount);
 
-    // Processing zero votes successfully for a given year indicates corrupt data
-    if (!successCount) {
-        // Major problem, needed data is missing
+    // Major problem, needed data is missing
+    if (rollCalls.getRollCallCount() == 0) {
         stringstream errorText;
-        errorText << "Required roll call data files for year " << year << " missing";
+        errorText << "Required roll call data files for years " << rollCalls.getFirstYear() << "-"
+                  << rollCalls.getLastYear() << " missing";
         cerr << errorText.str() << endl;
         throw ios_base::failure(errorText.str());
     }
+
+    short year;
+    for (year = rollCalls.getFirstYear(); year <= rollCalls.getLastYear(); year++) {
+        /* A year with no files is normal for a session in progress; the second year has
+            none until its first vote. The roll calls added later are read by addVotes() */
+        const vector<int>& rollCallNos = rollCalls.getRollCalls(year);
+        if (rollCallNos.empty())
+            continue;
+        // Processing zero votes successfully for a given year indicates corrupt data
+        if (!getVoteDiff(votes, congress, rollCalls, year, rollCallNos, workerCount, method)) {
+            stringstream errorText;
+            errorText << "Required roll call data files for year " << year << " missing";
+            cerr << errorText.str() << endl;
+            throw ios_base::failure(errorText.str());
+        }
+    }
+
+    if (method == diffWholeSession)
+        VoteDiffCounter::countDifferences(votes._passVotes, votes._voted, votes._differences,
+                                          votes._bothVoted, workerCount);
 }
 
-void VoteFactory::getVoteMatrix(VoteDiffMatrix& results, const CongressData& congress,
-                                short firstYear, short lastYear)
+/* Adds roll calls published after the results were read, such as during a session
+    in progress. The bit matrices must have room for them. The results are the same
+    as reading every file again, if the new roll calls all come after the old ones */
+void VoteFactory::addVotes(SessionVotes& votes, const CongressData& congress,
+                           const RollCallManifest& rollCalls,
+                           const map<short, vector<int> >& newRollCalls, unsigned int workerCount,
+                           DiffMethod method)
 {
-    // Insure previous results do not carry over
-    vector<short> tempResult(congress.getSize(), 0);
-    results.assign(congress.getSize(), tempResult);
-
-    /* HACK: Ideally, this routine will use system calls to find the last roll call
-        file, and from that know the upper limits of votes. Instead, it assumes that
-        vote files are resonably consecutive, so it can quit after a certain
-        number of consecutive failures. Setting the failure number higher makes this
-        routine more robust at the cost of less performance. Remember that roll
-        call votes that are not up or down count as failures! */
-    // SEMI-HACK: Handle this common problem
-    if (lastYear < firstYear) {
-        short temp = lastYear;
-        lastYear = firstYear;
-        firstYear = temp;
+    /* The differences are counts, so the new roll calls just add to them. Unlike a
+        full read, a year with no usable new votes is normal; the day's roll calls
+        may all have been quorum calls */
+    map<short, vector<int> >::const_iterator yearIndex;
+    unsigned int newRollCallCount = 0;
+    for (yearIndex = newRollCalls.begin(); yearIndex != newRollCalls.end(); yearIndex++)
+        newRollCallCount += yearIndex->second.size();
+    method = resolveDiffMethod(method, votes, newRollCallCount, workerCount);
+    for (yearIndex = newRollCalls.begin(); yearIndex != newRollCalls.end(); yearIndex++)
+        getVoteDiff(votes, congress, rollCalls, yearIndex->first, yearIndex->second, workerCount, method);
+
+    if (method == diffWholeSession)
+        VoteDiffCounter::countDifferences(votes._passVotes, votes._voted, votes._differences,
+                                          votes._bothVoted, workerCount);
+}
+
+/* Picks the fastest method for reading the given number of new roll calls into a
+    session that will then have the total given, using no more than the memory
+    given beyond what the results need anyway. A memory size of zero means unknown,
+    which only allows methods that need no extra memory. Never returns automatic */
+VoteFactory::DiffMethod VoteFactory::chooseDiffMethod(unsigned short memberCount, unsigned int newRollCallCount,
+                                                      unsigned int sessionRollCallCount, unsigned int workerCount,
+                                                      size_t availableMemory)
+{
+    /* Both methods visit every pair of members; they differ in how often and how
+        much work is done per visit. Whole session makes one visit, comparing every
+        word of the session's bits. By block makes one visit per block. The costs
+        are in nanoseconds per pair visit, measured with debugBenchmarkDiffMethods()
+        on 4000 members and 1700 roll calls. With more than one worker, adding each
+        worker's results to the total is about one more visit per worker.
+        NOTE: The wider bitsets compare no faster per word than a single word does
+        on that machine, so by these numbers they never win. Measure again on new
+        hardware */
+    const double wholeWordCost = 0.5;
+    const double blockVisitCosts[3] = { 3.7, 16.4, 40.5 };
+    const double mergeVisitCost = 0.5;
+    // Leave the rest of the memory for the rest of the system
+    const size_t memoryShare = 2;
+
+    if (workerCount > newRollCallCount)
+        workerCount = newRollCallCount;
+    if (workerCount < 1)
+        workerCount = 1;
+    const unsigned int wordBits = VoteBitMatrix::bitsPerWord;
+    double wholeCost = wholeWordCost * ((sessionRollCallCount + wordBits - 1) / wordBits);
+
+    DiffMethod bestMethod = diffWholeSession;
+    double bestCost = wholeCost;
+    const DiffMethod blockMethods[3] = { diffByBlock64, diffByBlock256, diffByBlock512 };
+    const unsigned int blockSizes[3] = { 64, 256, 512 };
+    unsigned short methodIndex;
+    for (methodIndex = 0; methodIndex < 3; methodIndex++) {
+        unsigned int blockSize = blockSizes[methodIndex];
+        /* Each worker reads its own range into its own blocks. With more than one,
+            each also needs its own results matrix */
+        size_t blockMemory = workerCount * 3 * (size_t)memberCount * (blockSize / CHAR_BIT);
+        if (workerCount > 1)
+            blockMemory += workerCount * ((size_t)memberCount * (memberCount + 1) / 2) * sizeof(short);
+        if (blockMemory > (availableMemory / memoryShare))
+            continue;
+
+        unsigned int workerRollCalls = (newRollCallCount + workerCount - 1) / workerCount;
+        unsigned int blockCount = workerCount * ((workerRollCalls + blockSize - 1) / blockSize);
+        double blockCost = blockCount * blockVisitCosts[methodIndex];
+        if (workerCount > 1)
+            blockCost += workerCount * mergeVisitCost;
+        if (blockCost < bestCost) {
+            bestMethod = blockMethods[methodIndex];
+            bestCost = blockCost;
+        }
+    } // For each block width
+    return bestMethod;
+}
+
+/* Replaces the automatic method with the one chooseDiffMethod() picks for reading
+    the given number of roll calls into the results */
+VoteFactory::DiffMethod VoteFactory::resolveDiffMethod(DiffMethod method, const SessionVotes& votes,
+                                                       unsigned int newRollCallCount, unsigned int workerCount)
+{
+    if (method != diffAutomatic)
+        return method;
+    return chooseDiffMethod(votes._passVotes.getMemberCount(), newRollCallCount,
+                            votes._passVotes.getRollCallCount() + newRollCallCount, workerCount,
+                            getAvailableMemory());
+}
+
+// Returns the bytes of physical memory not in use, or zero if unknown
+size_t VoteFactory::getAvailableMemory(void)
+{
+#ifdef _WIN32
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (!GlobalMemoryStatusEx(&status))
+        return 0;
+    return (size_t)status.ullAvailPhys;
+#else
+    long pageCount = sysconf(_SC_AVPHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if ((pageCount <= 0) || (pageSize <= 0))
+        return 0;
+    return (size_t)pageCount * (size_t)pageSize;
+#endif
+}
+
+/* Converts raw vote counts into differences on a scale of 0 to 1000, using the given
+    measure of difference */
+void VoteFactory::normalizeVoteMatrix(const SessionVotes& votes, VoteDiffMatrix& results,
+                                      DiffMetric metric)
+{
+    // Jaccard needs the number of votes each member cast
+    vector<int> voteCounts;
+    unsigned short member;
+    if (metric == metricJaccard)
+        for (member = 0; member < votes._differences.size(); member++)
+            voteCounts.push_back(votes._voted.countRow(member));
+    normalizeCounts(votes._differences, votes._bothVoted, voteCounts, votes._billCount, results, metric);
+}
+
+/* Converts raw counts into differences on a scale of 0 to 1000. The vote counts of
+    each member are only used by Jaccard */
+void VoteFactory::normalizeCounts(const VoteDiffMatrix& differences, const VoteDiffMatrix& bothVoted,
+                                  const vector<int>& voteCounts, int billCount,
+                                  VoteDiffMatrix& results, DiffMetric metric)
+{
+    results = differences;
+    // NASTY HACK: Avoid a divide by zero if nothing was read
+    if (billCount <= 0)
+        return;
+    if (metric == metricDisagreement) {
+        short* values = results.getValues();
+        size_t valueIndex;
+        for (valueIndex = 0; valueIndex < results.getValueCount(); valueIndex++) {
+            int tempResult = (int)values[valueIndex]; // Prevent overflow
+            tempResult = (tempResult * 1000) / billCount;
+            values[valueIndex] = (short)tempResult;
+        }
+        return;
     }
 
-    short billCount = 0;
-    short year;
-    for (year = firstYear; year <= lastYear; year++)
-        getVoteDiff(results, billCount, congress, year);
-
-    // Normalize the vote differences on a scale of 1 to 1000
-    unsigned short rowIndex, columnIndex;
-    for (rowIndex = 0; rowIndex < results.size(); rowIndex++)
-        for (columnIndex = 0; columnIndex < results.size(); columnIndex++) {
-            int tempResult = (int)results.at(rowIndex).at(columnIndex); // Prevent overflow
-            tempResult = (tempResult * 1000) / (int)billCount;
-            results.at(rowIndex).at(columnIndex) = (short)tempResult;
+    /* Both the other metrics divide the roll calls where a pair voted the same way
+        by some total. A pair with a total of zero has nothing in common, so they
+        are as far apart as possible. Each member is always zero from themselves */
+    unsigned short row, column;
+    for (row = 0; row < results.size(); row++) {
+        const short* differenceRow = differences.getRow(row);
+        const short* bothVotedRow = bothVoted.getRow(row);
+        short* resultRow = results.getRow(row);
+        for (column = 0; column < row; column++) {
+            int sameVotes = billCount - (int)differenceRow[column];
+            int total;
+            if (metric == metricAbsenceCorrected)
+                total = bothVotedRow[column];
+            else
+                total = voteCounts[row] + voteCounts[column] - sameVotes;
+            if (total > 0)
+                resultRow[column] = (short)(((total - sameVotes) * 1000) / total);
+            else
+                resultRow[column] = 1000;
         }
+        resultRow[row] = 0;
+    } // For each row
+}
+
+/* Finds the differences for a series of windows of roll calls moving through the
+    session. Each window holds the given number of roll calls and starts the step
+    after the one before, both rounded up to whole words of the vote bits */
+void VoteFactory::getWindowMatrices(const SessionVotes& votes, unsigned int windowRollCalls,
+                                    unsigned int stepRollCalls, vector<VoteDiffMatrix>& results,
+                                    DiffMetric metric, unsigned int workerCount)
+{
+    const unsigned int wordSize = VoteBitMatrix::bitsPerWord;
+    unsigned int windowWords = std::max(1u, (windowRollCalls + wordSize - 1) / wordSize);
+    unsigned int stepWords = std::max(1u, (stepRollCalls + wordSize - 1) / wordSize);
+
+    /* Every window starts and ends on a multiple of the step and window sizes, so
+        snapshots are only needed at multiples of their greatest common divisor.
+        Taking them further apart saves memory */
+    unsigned int wordsPerSnapshot = std::gcd(windowWords, stepWords);
+    VoteWindows windows;
+    windows.build(votes._passVotes, votes._voted, wordsPerSnapshot, workerCount);
+
+    results.clear();
+    size_t lastSnapshot = windows.getSnapshotCount() - 1;
+    size_t windowSnapshots = windowWords / wordsPerSnapshot;
+    size_t stepSnapshots = stepWords / wordsPerSnapshot;
+    VoteDiffMatrix differences, bothVoted;
+    vector<int> voteCounts;
+    size_t first = 0;
+    do {
+        size_t last = std::min(first + windowSnapshots, lastSnapshot);
+        windows.getWindow(first, last, differences, bothVoted, voteCounts);
+        results.push_back(VoteDiffMatrix());
+        normalizeCounts(differences, bothVoted, voteCounts,
+                        windows.getRollCallCount(last) - windows.getRollCallCount(first),
+                        results.back(), metric);
+        first += stepSnapshots;
+    } while ((first + windowSnapshots) <= lastSnapshot);
+}
+
+void VoteFactory::getVoteMatrix(VoteDiffMatrix& results, const CongressData& congress,
+                                const RollCallManifest& rollCalls, unsigned int workerCount,
+                                DiffMethod method, DiffMetric metric)
+{
+    SessionVotes votes;
+    readVotes(votes, congress, rollCalls, workerCount, method);
+    normalizeVoteMatrix(votes, results, metric);
 }
 
 /* The final layout is based on the similarities of votes. Pairs of groups with large numbers of different
     votes will have little efffect on the final layout. Filter them out to reduce compute */
 void VoteFactory::filterLargeMismatch(VoteDiffMatrix& results, short threshold)
 {
-    unsigned short index1, index2;
-    for (index1 = 0; index1 < results.size(); index1++)
-        for (index2 = 0; index2 < results[index1].size(); index2++)
-            if (results[index1][index2] > threshold)
-                results[index1][index2] = -1;
+    short* values = results.getValues();
+    size_t valueIndex;
+    for (valueIndex = 0; valueIndex < results.getValueCount(); valueIndex++)
+        if (values[valueIndex] > threshold)
+            values[valueIndex] = -1;
 }
 
 // Debug method to print out the vote resuls matrix
@@ -242,8 +651,118 @@ void VoteFactory::debugOutputVoteMatrix(const VoteDiffMatrix& results)
         for (rowIndex = 0; rowIndex < results.size(); rowIndex++) {
             cerr << std::setw(4) << rowIndex << " ";
             for (columnIndex = startColumn; columnIndex < endColumn; columnIndex++)
-                cerr << std::setw(4) << results.at(rowIndex).at(columnIndex) << " ";
+                cerr << std::setw(4) << results.get(rowIndex, columnIndex) << " ";
             cerr << endl;
         }  // For every row
     } // Block Count
 }
+
+/* Counts the differences of a session by block from the votes already read, and
+    returns the time taken in milliseconds */
+template<size_t blockSize>
+double VoteFactory::debugTimeBlocks(const SessionVotes& votes, unsigned int iterations,
+                                    VoteDiffMatrix& results, VoteDiffMatrix& bothVoted)
+{
+    typedef std::chrono::steady_clock Clock;
+    typedef bitset<blockSize> Votes;
+    unsigned short memberCount = votes._passVotes.getMemberCount();
+    unsigned int rollCallCount = votes._passVotes.getRollCallCount();
+
+    /* Rebuild the blocks the files would be read into from the session bits. Only
+        the counting is timed */
+    vector<vector<Votes> > passBlocks, votedBlocks;
+    vector<Votes> usedBlocks;
+    unsigned int rollCallIndex;
+    for (rollCallIndex = 0; rollCallIndex < rollCallCount; rollCallIndex += blockSize) {
+        passBlocks.push_back(vector<Votes>(memberCount));
+        votedBlocks.push_back(vector<Votes>(memberCount));
+        usedBlocks.push_back(Votes());
+        unsigned short blockOffset;
+        for (blockOffset = 0; (blockOffset < blockSize) &&
+                              ((rollCallIndex + blockOffset) < rollCallCount); blockOffset++) {
+            unsigned short member;
+            for (member = 0; member < memberCount; member++) {
+                if (votes._passVotes.test(member, rollCallIndex + blockOffset))
+                    passBlocks.back()[member].set(blockOffset);
+                if (votes._voted.test(member, rollCallIndex + blockOffset))
+                    votedBlocks.back()[member].set(blockOffset);
+            }
+            usedBlocks.back().set(blockOffset);
+        }
+    } // For each block
+
+    Clock::time_point start = Clock::now();
+    unsigned int pass;
+    for (pass = 0; pass < iterations; pass++) {
+        results.assign(memberCount, 0);
+        bothVoted.assign(memberCount, 0);
+        unsigned int blockIndex;
+        for (blockIndex = 0; blockIndex < passBlocks.size(); blockIndex++)
+            convVoteResultToDiff(passBlocks[blockIndex], votedBlocks[blockIndex], usedBlocks[blockIndex],
+                                 results, bothVoted);
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+}
+
+/* Times counting the differences of a session by block with each width and for the
+    whole session at once, from the votes already read. Results are written to
+    standard error */
+void VoteFactory::debugBenchmarkDiffMethods(const SessionVotes& votes, unsigned int iterations)
+{
+    typedef std::chrono::steady_clock Clock;
+    VoteDiffMatrix sessionResults, sessionBothVoted;
+    Clock::time_point start = Clock::now();
+    unsigned int pass;
+    for (pass = 0; pass < iterations; pass++)
+        VoteDiffCounter::countDifferences(votes._passVotes, votes._voted, sessionResults, sessionBothVoted);
+    double sessionTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+    cerr << "Whole session: " << sessionTime << " ms" << endl;
+
+    VoteDiffMatrix blockResults[3], blockBothVoted[3];
+    double blockTimes[3];
+    blockTimes[0] = debugTimeBlocks<64>(votes, iterations, blockResults[0], blockBothVoted[0]);
+    blockTimes[1] = debugTimeBlocks<256>(votes, iterations, blockResults[1], blockBothVoted[1]);
+    blockTimes[2] = debugTimeBlocks<512>(votes, iterations, blockResults[2], blockBothVoted[2]);
+    const unsigned int blockSizes[3] = { 64, 256, 512 };
+    unsigned short methodIndex;
+    for (methodIndex = 0; methodIndex < 3; methodIndex++) {
+        cerr << "By block of " << blockSizes[methodIndex] << ": " << blockTimes[methodIndex] << " ms, "
+             << (blockTimes[methodIndex] / sessionTime) << "x whole session";
+        if ((blockResults[methodIndex] != sessionResults) || (blockBothVoted[methodIndex] != sessionBothVoted))
+            cerr << " WARNING: results differ";
+        cerr << endl;
+    }
+}
+
+/* Checks reading a session in its first year, when the second year has no roll
+    call files yet. The session must read without error and match reading the first
+    year alone */
+void VoteFactory::debugCheckPartialSession(short firstYear, unsigned int workerCount)
+{
+    RollCallManifest sessionRollCalls(firstYear, firstYear + 1);
+    if (!sessionRollCalls.getRollCalls(firstYear + 1).empty()) {
+        cerr << "Session " << firstYear << "-" << (firstYear + 1)
+             << " has files for both years, check needs one with only the first" << endl;
+        return;
+    }
+    RollCallManifest yearRollCalls(firstYear);
+    CongressData congress(firstYear);
+
+    SessionVotes sessionVotes, yearVotes;
+    try {
+        readVotes(sessionVotes, congress, sessionRollCalls, workerCount);
+        readVotes(yearVotes, congress, yearRollCalls, workerCount);
+    }
+    catch (std::exception&) {
+        // The error was reported when thrown
+        cerr << "Session " << firstYear << "-" << (firstYear + 1) << " WARNING: read failed" << endl;
+        return;
+    }
+    cerr << "Session " << firstYear << "-" << (firstYear + 1) << ": " << sessionVotes._billCount
+         << " roll calls read";
+    if ((sessionVotes._billCount != yearVotes._billCount) ||
+        (sessionVotes._differences != yearVotes._differences) ||
+        (sessionVotes._bothVoted != yearVotes._bothVoted))
+        cerr << " WARNING: results differ from reading " << firstYear << " alone";
+    cerr << endl;
+}
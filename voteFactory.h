@@ -25,36 +25,188 @@
     actual results */
 
 #include<bitset>
+#include<map>
+#include<exception>
 
 using std::bitset;
+using std::map;
+using std::exception_ptr;
 using std::vector; // Does not include header; widely used and clients should have it
 
-/* The number of votes is large. This class can process them in blocks, to give memory
-    savings at the cost of performance. The parameter below controls the block size
-    (Bitwise operators only work on Bitset, not vector<bit>, and bitsize requires a size
-    at compilation, so need to use a define, not a configuration parameter) */
-#define ROLL_CALL_BLOCK_SIZE 8
-
-typedef vector<vector<short> > VoteDiffMatrix;
+// Only used by reference, so callers that don't need them don't need the headers
+class RollCall;
+class RollCallManifest;
+
+/* NOTE: Including headers in other headers is a double edged sword. The bit and difference
+    matrices are part of the results this class returns, so every user needs them anyway */
+#include"voteBitMatrix.h"
+#include"voteDiffMatrix.h"
+
+/* The number of votes is large. This class can count the differences a block of roll calls
+    at a time as the files are read, or for the whole session once every file is read. Blocks
+    are held in bitsets, whose size must be known at compilation, so the block routines are
+    templates with a version for each supported width. The width is picked at run time */
+
+/* Everything learned from reading the vote files of a session: how every Congressperson
+    voted on every up or down roll call, and the raw counts of vote differences between
+    each pair before they are normalized. Keeping the raw data allows saving it and
+    renormalizing later without reading the files again */
+struct SessionVotes
+{
+    VoteDiffMatrix _differences;
+    VoteDiffMatrix _bothVoted; // Roll calls where both members of the pair voted
+    short _billCount; // Number of roll calls included
+    VoteBitMatrix _passVotes; // Set if voted for the bill
+    VoteBitMatrix _voted; // Set if voted at all
+};
 
 class VoteFactory {
-    private:
-        typedef bitset<ROLL_CALL_BLOCK_SIZE> Votes;
-        typedef vector<Votes> VoteResults;
-
-        static void convVoteResultToDiff(VoteResults& passVotes, VoteResults& voted, VoteDiffMatrix& results);
+    public:
+        /* How the vote differences are counted. By block counts them as each block of
+            roll calls is read, with a pass over every pair of Congresspeople per block.
+            Whole session counts them in one pass over the session vote bits once every
+            file is read, comparing a full word of roll calls at a time. The results are
+            the same. Whole session is far faster for reading a session, but when adding
+            a few roll calls to saved results, counting just those by block is faster
+            than counting the whole session again. By block with more than one thread
+            needs a results matrix per thread. Automatic picks one with chooseDiffMethod() */
+        enum DiffMethod { diffAutomatic, diffByBlock64, diffByBlock256, diffByBlock512, diffWholeSession };
+
+        /* How the raw counts are turned into differences. Every one is counted in the same
+            pass over the votes, so they can be compared without reading the files again.
+            Disagreement is the share of all roll calls where the pair voted differently or
+            either did not vote. Absence corrected only looks at roll calls where both voted,
+            so a member who missed many votes is not pushed away from everyone; it is the
+            complement of the agreement rate when both voted. Jaccard treats each member's
+            cast votes as a set, and is one less the share of their combined votes the pair
+            cast the same way */
+        enum DiffMetric { metricDisagreement, metricAbsenceCorrected, metricJaccard };
 
-        /* Finds the vote differences for a range of bills for a single year and adds them to the results.
-            This method is private because it depends on consistency conditions enforced elsewhere */
-        static void getVoteDiff(VoteDiffMatrix& results, short& billCount,
-                                const CongressData& congress, short year);
+    private:
+        /* Given how congresspeople voted on bills, finds the number of differences in their
+            votes and the number of bills both voted on, and updates the results matrices. Only
+            the vote positions set in the mask are used */
+        template<size_t blockSize>
+        static void convVoteResultToDiff(const vector<bitset<blockSize> >& passVotes,
+                                         const vector<bitset<blockSize> >& voted,
+                                         const bitset<blockSize>& usedVotes, VoteDiffMatrix& results,
+                                         VoteDiffMatrix& bothVoted);
+
+        /* Adds the first voteCount roll calls of a block to the session results: they are
+            appended to the bit matrices, and their differences are counted if wanted */
+        template<size_t blockSize>
+        static void saveVoteBlock(const vector<bitset<blockSize> >& passVotes,
+                                  const vector<bitset<blockSize> >& voted, unsigned short voteCount,
+                                  bool countDifferences, SessionVotes& votes);
+
+        /* Finds the vote differences for the given roll calls of a single year and adds them to the
+            results. Returns the number of roll calls that contributed votes. This method is private
+            because it depends on consistency conditions enforced elsewhere */
+        static int getVoteDiff(SessionVotes& votes, const CongressData& congress,
+                               const RollCallManifest& rollCalls, short year,
+                               const vector<int>& rollCallNos, unsigned int workerCount,
+                               DiffMethod method);
+
+        /* Reads a range of roll calls from a year, adding them to the results. Returns the
+            number of roll calls that contributed votes. Calls readRollCallBlocks() with the
+            block width for the method */
+        static int readRollCalls(SessionVotes& votes, const CongressData& congress,
+                                 const RollCallManifest& rollCalls, short year,
+                                 vector<int>::const_iterator first, vector<int>::const_iterator last,
+                                 DiffMethod method);
+
+        // Reads a range of roll calls a block at a time. Returns the same as readRollCalls()
+        template<size_t blockSize>
+        static int readRollCallBlocks(SessionVotes& votes, const CongressData& congress,
+                                      const RollCallManifest& rollCalls, short year,
+                                      vector<int>::const_iterator first, vector<int>::const_iterator last,
+                                      bool countDifferences);
+
+        // Worker thread body. Calls readRollCalls() and saves any exception for the creating thread
+        static void readRollCallsWorker(SessionVotes& votes, int& successCount,
+                                        const CongressData& congress,
+                                        const RollCallManifest& rollCalls, short year,
+                                        vector<int>::const_iterator first, vector<int>::const_iterator last,
+                                        DiffMethod method, exception_ptr& error);
+
+        /* Reads one roll call file and sets its votes at the given offset in the block. Returns
+            true if the file was an up or down vote. The flag is set if any votes were recorded */
+        template<size_t blockSize>
+        static bool loadRollCall(RollCall& rollCall, const CongressData& congress,
+                                 const RollCallManifest& rollCalls, short year, int rollCallNo,
+                                 unsigned short blockOffset, vector<bitset<blockSize> >& passVotes,
+                                 vector<bitset<blockSize> >& voted, bool& haveVotes);
+
+        /* Replaces the automatic method with the one chooseDiffMethod() picks for reading
+            the given number of roll calls into the results */
+        static DiffMethod resolveDiffMethod(DiffMethod method, const SessionVotes& votes,
+                                            unsigned int newRollCallCount, unsigned int workerCount);
+
+        /* Converts raw counts into differences on a scale of 0 to 1000. The vote counts of
+            each member are only used by Jaccard */
+        static void normalizeCounts(const VoteDiffMatrix& differences, const VoteDiffMatrix& bothVoted,
+                                    const vector<int>& voteCounts, int billCount,
+                                    VoteDiffMatrix& results, DiffMetric metric);
+
+        // Returns the bytes of physical memory not in use, or zero if unknown
+        static size_t getAvailableMemory(void);
+
+        /* Counts the differences of a session by block from the votes already read, and
+            returns the time taken in milliseconds */
+        template<size_t blockSize>
+        static double debugTimeBlocks(const SessionVotes& votes, unsigned int iterations,
+                                      VoteDiffMatrix& results, VoteDiffMatrix& bothVoted);
 
     public:
-        /* Calculate the vote differences. The congress data is passed in because
-            the caller will also need it for other purposes */
-        static void getVoteMatrix(VoteDiffMatrix& results, const CongressData& congress, short firstYear,
-                                  short lastYear = 0);
-
+        /* Calculate the vote differences for the roll calls in the manifest. The congress
+            data is passed in because the caller will also need it for other purposes. Vote
+            files are read, and the differences counted, by the given number of threads; the
+            results do not depend on the count */
+        static void getVoteMatrix(VoteDiffMatrix& results, const CongressData& congress,
+                                  const RollCallManifest& rollCalls, unsigned int workerCount = 1,
+                                  DiffMethod method = diffAutomatic, DiffMetric metric = metricDisagreement);
+
+        /* Reads the votes for the roll calls in the manifest, without normalizing the
+            differences. Threading is the same as getVoteMatrix(). A year with no files is
+            skipped, as for a session in progress; throws ios_base::failure if no year has
+            any, or a year's files have no usable votes */
+        static void readVotes(SessionVotes& votes, const CongressData& congress,
+                              const RollCallManifest& rollCalls, unsigned int workerCount = 1,
+                              DiffMethod method = diffAutomatic);
+
+        /* Adds roll calls published after the results were read, such as during a session
+            in progress. The bit matrices must have room for them. The results are the same
+            as reading every file again, if the new roll calls all come after the old ones */
+        static void addVotes(SessionVotes& votes, const CongressData& congress,
+                             const RollCallManifest& rollCalls,
+                             const map<short, vector<int> >& newRollCalls, unsigned int workerCount = 1,
+                             DiffMethod method = diffAutomatic);
+
+        /* Picks the fastest method for reading the given number of new roll calls into a
+            session that will then have the total given, using no more than the memory
+            given beyond what the results need anyway. A memory size of zero means unknown,
+            which only allows methods that need no extra memory. Never returns automatic */
+        static DiffMethod chooseDiffMethod(unsigned short memberCount, unsigned int newRollCallCount,
+                                           unsigned int sessionRollCallCount, unsigned int workerCount,
+                                           size_t availableMemory);
+
+        /* Converts raw vote counts into differences on a scale of 0 to 1000, using the given
+            measure of difference */
+        static void normalizeVoteMatrix(const SessionVotes& votes, VoteDiffMatrix& results,
+                                        DiffMetric metric = metricDisagreement);
+
+        /* Finds the differences for a series of windows of roll calls moving through the
+            session, to show how voting changes within it. Each window holds the given
+            number of roll calls and starts the step after the one before. Both are rounded
+            up to whole words of the vote bits (64 roll calls, around a month of House
+            votes). Windows running past the end of the session are left out, but a session
+            shorter than one window gets a single window of all of it. Each result can be
+            clustered and laid out like the session matrix; see
+            GraphFactory::makeWindowGraphs(). The given number of threads count the votes;
+            the results do not depend on it */
+        static void getWindowMatrices(const SessionVotes& votes, unsigned int windowRollCalls,
+                                      unsigned int stepRollCalls, vector<VoteDiffMatrix>& results,
+                                      DiffMetric metric = metricDisagreement, unsigned int workerCount = 1);
 
         /* The final layout is based on the similarities of votes. Pairs of groups with large numbers of different
             votes will have little efffect on the final layout. Filter them out to reduce compute */
@@ -62,4 +214,14 @@ class VoteFactory {
 
         // Debug method to print out the vote resuls matrix
         static void debugOutputVoteMatrix(const VoteDiffMatrix& results);
+
+        /* Times counting the differences of a session by block with each width and for the
+            whole session at once, from the votes already read. Results are written to
+            standard error */
+        static void debugBenchmarkDiffMethods(const SessionVotes& votes, unsigned int iterations = 5);
+
+        /* Checks reading a session in its first year, when the second year has no roll
+            call files yet. The session must read without error and match reading the first
+            year alone. Results are written to standard error */
+        static void debugCheckPartialSession(short firstYear, unsigned int workerCount = 1);
 };
@@ -0,0 +1,113 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+
+// Vote difference counts for windows of roll calls within a session
+#include<vector>
+#include<bitset>
+#include<algorithm>
+#include<utility>
+#include<stdexcept>
+#include"voteDiffCounter.h"
+#include"voteWindows.h"
+
+using std::vector;
+using std::bitset;
+
+VoteWindows::VoteWindows() : _snapshots()
+{
+}
+
+/* Counts the snapshots for the given votes, one every given number of words of
+    roll calls. The last one is at the end of the session. Throws out_of_range if
+    the two bit matrices don't match */
+void VoteWindows::build(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+                        unsigned int wordsPerSnapshot, unsigned int threadCount)
+{
+    if ((passVotes.getMemberCount() != voted.getMemberCount()) ||
+        (passVotes.getRollCallCount() != voted.getRollCallCount()))
+        throw std::out_of_range("VoteWindows vote bit matrices differ in size");
+    if (wordsPerSnapshot < 1)
+        wordsPerSnapshot = 1;
+
+    /* Every snapshot but the first is a running total from the start of the
+        session, which the counter finds with one visit to each pair */
+    vector<VoteDiffMatrix> differences, bothVoted;
+    VoteDiffCounter::countRunningTotals(passVotes, voted, wordsPerSnapshot, differences,
+                                        bothVoted, threadCount);
+
+    unsigned short memberCount = passVotes.getMemberCount();
+    _snapshots.assign(differences.size() + 1, Snapshot());
+    _snapshots[0]._rollCallCount = 0;
+    _snapshots[0]._differences.assign(memberCount, 0);
+    _snapshots[0]._bothVoted.assign(memberCount, 0);
+    _snapshots[0]._voteCounts.assign(memberCount, 0);
+    unsigned int wordCount = passVotes.getWordsPerRow();
+    size_t snapshot;
+    for (snapshot = 1; snapshot < _snapshots.size(); snapshot++) {
+        Snapshot& current = _snapshots[snapshot];
+        std::swap(current._differences, differences[snapshot - 1]);
+        std::swap(current._bothVoted, bothVoted[snapshot - 1]);
+
+        // Add the votes cast since the last snapshot to its totals
+        unsigned int firstWord = (snapshot - 1) * wordsPerSnapshot;
+        unsigned int lastWord = std::min(firstWord + wordsPerSnapshot, wordCount);
+        current._voteCounts = _snapshots[snapshot - 1]._voteCounts;
+        unsigned short member;
+        unsigned int wordIndex;
+        for (member = 0; member < memberCount; member++) {
+            const VoteBitMatrix::Word* votedRow = voted.getRow(member);
+            for (wordIndex = firstWord; wordIndex < lastWord; wordIndex++)
+                current._voteCounts[member] += bitset<VoteBitMatrix::bitsPerWord>(votedRow[wordIndex]).count();
+        }
+        current._rollCallCount = std::min(passVotes.getRollCallCount(),
+                                          lastWord * VoteBitMatrix::bitsPerWord);
+    } // For each snapshot
+}
+
+/* Gets the counts for the roll calls between two snapshots. Throws out_of_range
+    if either snapshot does not exist or they are out of order */
+void VoteWindows::getWindow(size_t firstSnapshot, size_t lastSnapshot, VoteDiffMatrix& differences,
+                            VoteDiffMatrix& bothVoted, vector<int>& voteCounts) const
+{
+    if ((lastSnapshot >= _snapshots.size()) || (firstSnapshot > lastSnapshot))
+        throw std::out_of_range("VoteWindows snapshot out of range");
+
+    const Snapshot& first = _snapshots[firstSnapshot];
+    const Snapshot& last = _snapshots[lastSnapshot];
+    differences = last._differences;
+    bothVoted = last._bothVoted;
+    voteCounts = last._voteCounts;
+
+    short* values = differences.getValues();
+    short* bothVotedValues = bothVoted.getValues();
+    const short* firstValues = first._differences.getValues();
+    const short* firstBothVoted = first._bothVoted.getValues();
+    size_t valueIndex;
+    for (valueIndex = 0; valueIndex < differences.getValueCount(); valueIndex++) {
+        values[valueIndex] -= firstValues[valueIndex];
+        bothVotedValues[valueIndex] -= firstBothVoted[valueIndex];
+    }
+    size_t member;
+    for (member = 0; member < voteCounts.size(); member++)
+        voteCounts[member] -= first._voteCounts[member];
+}
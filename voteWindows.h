@@ -0,0 +1,96 @@
+/* This file is part of CongressRelationVis. This project creates graphs
+   showing simmilarity of voting of different members of the US House of
+   Representatives.
+
+    Copyright (C) 2013   Ezra Erb
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 3 as published
+    by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    I'd appreciate a note if you find this program useful or make
+    updates. Please contact me through LinkedIn or github (my profile
+    also has a link to the code depository)
+*/
+/* This class shows how voting changes within a session, by finding the vote
+    difference counts for windows of consecutive roll calls. Counting each window
+    from the vote bits would visit every pair of Congresspeople once per window,
+    and a series of overlapping windows counts most roll calls many times over.
+
+    Instead it keeps snapshots of the running totals: the counts for every roll
+    call from the start of the session up to each snapshot. The counts for the
+    roll calls between two snapshots are the later totals less the earlier ones,
+    so any window starting and ending on a snapshot costs one subtraction per
+    pair, and building the snapshots counts each roll call once.
+
+    Roll calls are packed 64 to a word in the vote bits, so snapshots are taken
+    every whole number of words. A snapshot holds two full difference matrices,
+    so the memory needed grows with the square of the members times the number
+    of snapshots. Taking one every word is fine for a House session, about 450
+    members and a few dozen words; much larger sets of members should take them
+    further apart */
+#ifndef VOTE_WINDOWS_H_INCLUDED
+#define VOTE_WINDOWS_H_INCLUDED
+
+#include<vector>
+#include"voteBitMatrix.h"
+#include"voteDiffMatrix.h"
+
+using std::vector;
+
+class VoteWindows
+{
+public:
+    VoteWindows();
+
+    /* Counts the snapshots for the given votes, one every given number of words of
+        roll calls. The last one is at the end of the session, even if it falls inside
+        a word. The work is split between the given number of threads; the results do
+        not depend on the count. Throws out_of_range if the two bit matrices don't match */
+    void build(const VoteBitMatrix& passVotes, const VoteBitMatrix& voted,
+               unsigned int wordsPerSnapshot = 1, unsigned int threadCount = 1);
+
+    // Number of snapshots, including the empty one before the first roll call
+    size_t getSnapshotCount(void) const;
+
+    // Number of roll calls before a snapshot. The index is not checked
+    unsigned int getRollCallCount(size_t snapshot) const;
+
+    /* Gets the counts for the roll calls between two snapshots: the differences and
+        roll calls both voted on for each pair, as counted by VoteDiffCounter, and the
+        votes cast by each member. Throws out_of_range if either snapshot does not
+        exist or they are out of order */
+    void getWindow(size_t firstSnapshot, size_t lastSnapshot, VoteDiffMatrix& differences,
+                   VoteDiffMatrix& bothVoted, vector<int>& voteCounts) const;
+
+private:
+    // Running totals from the start of the session
+    struct Snapshot {
+        unsigned int _rollCallCount;
+        VoteDiffMatrix _differences;
+        VoteDiffMatrix _bothVoted;
+        vector<int> _voteCounts;
+    };
+
+    vector<Snapshot> _snapshots;
+};
+
+inline size_t VoteWindows::getSnapshotCount(void) const
+{
+    return _snapshots.size();
+}
+
+inline unsigned int VoteWindows::getRollCallCount(size_t snapshot) const
+{
+    return _snapshots[snapshot]._rollCallCount;
+}
+
+#endif // VOTE_WINDOWS_H_INCLUDED
@@ -31,27 +31,25 @@
 	of tags are processed, and they appear in a defined order in well-formed
 	files. Searching for them specifically should be more efficient.
 	*/
-#include<fstream>
 #include<string>
-#include<sstream>
+#include<string_view>
 #include<iostream>
 #include<algorithm>
+#include<cstring>
+#include<cctype>
+#include<charconv>
+#include"keySearch.h"
 #include"xmlParser.h"
 
-/* NASTY HACK: Hardcode the file path to the roll call files. This should
-    really be in a configuration file, but will work for this program */
-#define ROLL_DIRECTORY "GovTrackData"
-
 using std::string;
-using std::ifstream;
-using std::istringstream;
+using std::string_view;
 using std::cerr;
 using std::endl;
 
 /* Constructor. Note that this is protected to prevent using this class being
    used outside a subclass that does the actual XML parsing. */
 
-XmlParser::XmlParser() : _file(), _buffer(), _fileDirectory()
+XmlParser::XmlParser() : _file(), _fileText(), _buffer(), _fileDirectory()
 {
    _parseTrace = false;
    clearFileData();
@@ -66,22 +64,38 @@ XmlParser::~XmlParser()
 
 // Private inline methods must be declared before they are called
 /* Internal method to reload the internal buffer with the next line of
-    the file. This exists to get around C++ limitation of loading a file line
-    by line with formatted input (it can only be done with unformatted reads) */
+    the file. The buffer is a view into the mapped file, so this just finds
+    the next line break; nothing is copied */
 inline void XmlParser::reloadBuffer(void)
 {
-    if (haveEOF()) {
+    if (haveEOF())
         // Can't extract anything, so set to empty string
-        string temp;
-        _buffer = temp;
-    }
+        _buffer = string_view();
     else {
-        getline(_file, _buffer);
+        const char* lineStart = _fileText.data() + _nxtLinePos;
+        size_t remaining = _fileText.size() - _nxtLinePos;
+        const char* lineEnd = (const char*)memchr(lineStart, '\n', remaining);
+        size_t lineLength;
+        if (lineEnd == 0) {
+            // Last line of the file has no line break
+            lineLength = remaining;
+            _nxtLinePos = _fileText.size();
+        }
+        else {
+            lineLength = lineEnd - lineStart;
+            _nxtLinePos += lineLength + 1; // Skip the line break too
+        }
+        /* Files written on Windows end lines with CR LF. Text mode streams hid
+            this; a raw mapping does not, so strip it here to keep line contents
+            identical */
+        if ((lineLength > 0) && (lineStart[lineLength - 1] == '\r'))
+            lineLength--;
+        _buffer = string_view(lineStart, lineLength);
         if (_parseTrace)
             cerr << _buffer << endl;
     }
     if (_buffer.empty())
-        _nxtSrchPos = string::npos; // Nothing to process
+        _nxtSrchPos = string_view::npos; // Nothing to process
     else
         _nxtSrchPos = 0;
 }
@@ -99,12 +113,12 @@ void XmlParser::burnToKey(const string& key, bool burnToEOF, bool burnKey)
         return; // Current line is burned, and no more lines to read
     // Check remainder of current line first
     if (!haveLineEnd())
-        _nxtSrchPos = _buffer.find(key, _nxtSrchPos + 1);
+        _nxtSrchPos = KeySearch::find(_buffer, key, _nxtSrchPos + 1);
     while ((!haveEOF()) && haveLineEnd() && (burnToEOF || (!_buffer.size()))) {
         // Read and check more lines
         reloadBuffer();
         // Reading the last line of the file sets EOF; still need to check the buffer
-        _nxtSrchPos = _buffer.find(key, _nxtSrchPos + 1);
+        _nxtSrchPos = KeySearch::find(_buffer, key, _nxtSrchPos + 1);
     } // While lines left in the file and reason to read them
     if (!haveLineEnd()) { // Found something
         if (_parseTrace)
@@ -129,14 +143,14 @@ bool XmlParser::burnChars(unsigned int charCount)
 
     if ((_nxtSrchPos + charCount) > _buffer.length()) {
         // Buffer not long enough
-        _nxtSrchPos = string::npos;
+        _nxtSrchPos = string_view::npos;
         return false;
     }
     else {
         _nxtSrchPos += charCount;
         // Check for the case where the burn uses up the buffer
         if (_nxtSrchPos >= _buffer.length())
-            _nxtSrchPos = string::npos;
+            _nxtSrchPos = string_view::npos;
         return true;
     }
 }
@@ -145,13 +159,30 @@ bool XmlParser::burnChars(unsigned int charCount)
     them. The rules are the same as char burning. If the line runs out early,
     the size of the result will be shorter than the request */
 string XmlParser::getText(unsigned int charCount)
+{
+    return string(getTextView(charCount));
+}
+
+/* Extracts chars from the current text up to (but not including) the passed
+   token, and then burns them. The rules are the same as char burning. If the
+   token does not exist the return value is all data to the end of the line.
+   If the client needs to check that the token exists, call haveLineEnd() after
+   this routine (remember that the token is NOT included in the burn) */
+string XmlParser::getTextToToken(char token)
+{
+    return string(getTextViewToToken(token));
+}
+
+/* Version of getText() that returns a view into the file instead of a copy.
+    The view is valid until the file is closed */
+string_view XmlParser::getTextView(unsigned int charCount)
 {
     // Extract text, then burn
-    string result;
-    if (haveTextToProcess() && (charCount > 0)) {
+    string_view result;
+    if (haveTextToProcess() && (!haveLineEnd()) && (charCount > 0)) {
         if (_parseTrace)
             cerr << "Extract " << charCount << " chars starting at " << _nxtSrchPos;
-        result = string(_buffer, _nxtSrchPos, charCount);
+        result = _buffer.substr(_nxtSrchPos, charCount);
         if (_parseTrace)
             // Since whitespace can be important for parsing, show the result between '
             cerr << ":'" << result << "'" << endl;
@@ -160,33 +191,26 @@ string XmlParser::getText(unsigned int charCount)
     return result;
 }
 
-/* Extracts chars from the current text up to (but not including) the passed
-   token, and then burns them. The rules are the same as char burning. If the
-   token does not exist the return value is all data to the end of the line.
-   If the client needs to check that the token exists, call haveLineEnd() after
-   this routine (remember that the token is NOT included in the burn) */
-string XmlParser::getTextToToken(char token)
+/* Version of getTextToToken() that returns a view into the file instead of a
+    copy. The view is valid until the file is closed */
+string_view XmlParser::getTextViewToToken(char token)
 {
-    if (!haveTextToProcess()) {
-        string result;
-        return result;
-    }
+    if (!haveTextToProcess())
+        return string_view();
     // Find the position of the char
-    unsigned int charPos = _buffer.find_first_of(token, _nxtSrchPos);
+    size_t charPos = KeySearch::find(_buffer, string_view(&token, 1), _nxtSrchPos);
 
     if (_parseTrace)
         cerr << "Get to Token:" << token << " located at " << charPos << endl;
 
     // If the next character IS the token, nothing to extract
-    if (charPos == _nxtSrchPos) {
-        string result;
-        return result;
-    }
+    if (charPos == _nxtSrchPos)
+        return string_view();
 
     // If the token is not found, set the final position to one beyond end
-    if (charPos == string::npos)
+    if (charPos == string_view::npos)
         charPos = _buffer.length() + 1;
-    return getText(charPos - _nxtSrchPos);
+    return getTextView(charPos - _nxtSrchPos);
 }
 
 /* Extracts a number from the current text from the current position to
@@ -194,20 +218,30 @@ string XmlParser::getTextToToken(char token)
     was read, else false. The text before the token is burned regardless */
 bool XmlParser::getNumberToToken(char token, int& number)
 {
-    istringstream temp(getTextToToken(token));
+    string_view text(getTextViewToToken(token));
     bool success;
     if (haveLineEnd())
         success = false;
-    else {
-        // C++ method of converting a string to a short
-        temp >> number;
-
-        /* There are other methods of getting this result (including the ! operator!)
-            but they are really just cryptic wrappers around the statement below */
-        success = !temp.fail();
-    }
+    else
+        success = textToNumber(text, number);
     if (!success)
         number = 0; // Ensure consistent behavior
     return success;
 }
 
+/* Converts text to a number the way a stream would: leading whitespace and
+    a plus sign are allowed, and conversion stops at the first char that is
+    not part of the number. Returns true if a number was found
+    NOTE: This replaced a string stream, which allocated memory for every
+    number. from_chars() works on the text in place */
+bool XmlParser::textToNumber(string_view text, int& number)
+{
+    const char* next = text.data();
+    const char* end = text.data() + text.size();
+    while ((next < end) && isspace((unsigned char)*next))
+        next++;
+    // from_chars() takes a minus sign but not a plus
+    if (((end - next) > 1) && (*next == '+') && isdigit((unsigned char)next[1]))
+        next++;
+    return (std::from_chars(next, end, number).ec == std::errc());
+}
@@ -29,16 +29,37 @@
 	This class was chosen over a full XML library because only a low number
 	of tags are processed, and they appear in a defined order in well-formed
 	files. Searching for them specifically should be more efficient.
+
+	Files are memory mapped rather than streamed. Every file is read start to
+	finish, and the data files number in the thousands per session, so the
+	cost of copying each line into a string dominated the parse. The current
+	line is now a view into the mapped file; only text actually extracted by
+	a subclass gets copied.
+
+	Subclasses that only examine a value, or convert it to a number, should
+	use the view versions of the text methods. These return views into the
+	mapped file instead of new strings, so parsing a record needs no heap
+	allocation at all. The views stay valid until the file is closed.
+
+	The text can also come from memory owned by someone else, such as a file
+	inside a mapped archive. The parser then only keeps a view of it.
 	*/
 
 // Standard technique to allow multiple header inclusion (needed due to being a subclass
 #ifndef XML_PARSER_DEFINE
 #define XML_PARSER_DEFINE
 
-#include<fstream>
+#include<string>
+#include<string_view>
+#include<iostream>
+#include"mappedFile.h"
+
+/* NASTY HACK: Hardcode the file path to the roll call files. This should
+    really be in a configuration file, but will work for this program */
+#define ROLL_DIRECTORY "GovTrackData"
 
 using std::string;
-using std::ifstream;
+using std::string_view;
 using std::cerr;
 using std::endl;
 
@@ -62,6 +83,10 @@ protected:
     // Opens a specific XML file. Returns true if succeeded, else false
 	bool open(const string& filename);
 
+    /* Parses text already in memory, instead of a file. The caller owns the
+        text, and it must stay valid until this object is closed */
+    void openText(string_view text);
+
     // Closes the current XML file, if any, and clears object state
 	void close(void);
 
@@ -104,15 +129,28 @@ protected:
         token is not included in the burn) */
 	string getTextToToken(char token);
 
+    /* Versions of getText() and getTextToToken() that return a view into the
+        file instead of a copy. The rules are the same. The view is valid
+        until the file is closed */
+    string_view getTextView(unsigned int charCount);
+    string_view getTextViewToToken(char token);
+
     /* Extracts a number from the current text from the current position to
         the passed token. The token must exist. Returns true if a number
         was read, else false The text before the token is burned regardless */
     bool getNumberToToken(char token, int& number);
 
+    /* Converts text to a number the way a stream would: leading whitespace and
+        a plus sign are allowed, and conversion stops at the first char that is
+        not part of the number. Returns true if a number was found */
+    static bool textToNumber(string_view text, int& number);
+
 private:
-  std::ifstream _file; // Actual file
-  string _buffer; // Line from file currently being processed
-  double _nxtSrchPos; // Next char in the buffer to process
+  MappedFile _file; // Actual file, if the text came from one
+  string_view _fileText; // All text being parsed. Points into _file or memory owned by the caller
+  string_view _buffer; // Line from file currently being processed. Points into _fileText
+  size_t _nxtLinePos; // Offset in the file of the line after the buffer
+  size_t _nxtSrchPos; // Next char in the buffer to process
 
 
   // Flag to dump the file parsing data to standard error
@@ -150,40 +188,43 @@ inline void XmlParser::setTrace(void)
 inline void XmlParser::setFileDirectory(const string& directory)
 {
     _fileDirectory = directory;
-    /* The passed directory does not include the backslash needed before the filename,
+    /* The passed directory does not include the separator needed before the filename,
         so add it
-        TRICKY NOTE: Notice the double backslash below. C++ uses '\' as an
-        escape character. The first is the esacpe character needed to insert a
-        litteral '\' in the string! */
-    _fileDirectory.append("\\");
+        NOTE: Windows accepts a forward slash as well as its native backslash. The
+        directory is also scanned through the standard library to find roll call
+        files, and a backslash is not a separator anywhere else, so use the slash */
+    _fileDirectory.append("/");
 }
 
 inline void XmlParser::close(void)
 {
+    /* The buffer points into the mapped file, so clearing it here is what keeps
+        it from dangling after the unmap */
     _file.close();
+    _fileText = string_view();
     clearFileData();
 }
 
 inline bool XmlParser::isOpen(void)
 {
-    return _file.is_open();
+    // Open text always has a position, even when empty
+    return (_fileText.data() != 0);
 }
 
 // Returns true if the end of the file processing has been reached
 inline bool XmlParser::haveEOF(void)
 {
-    /* This class reads unformatted input, so the end of the file or a fatal
-        error indicates end of processing */
+    // End of processing is when the last line has been loaded into the buffer
     if (!isOpen())
         return true;
     else
-        return (_file.bad() || _file.eof());
+        return (_nxtLinePos >= _fileText.size());
 }
 
 // Returns true if the end of a line has been reached
 inline bool XmlParser::haveLineEnd(void)
 {
-    return (_nxtSrchPos == string::npos);
+    return (_nxtSrchPos == string_view::npos);
 }
 
 // Returns true if there is still text to process.
@@ -197,7 +238,7 @@ inline bool XmlParser::haveTextToProcess(void)
 
 inline bool XmlParser::open(const string& fileName)
 {
-    if (_file.is_open())
+    if (isOpen())
         close();
     // Closing the file invalidates the processing data
 
@@ -206,18 +247,35 @@ inline bool XmlParser::open(const string& fileName)
     // Trace the full file path, to catch the error where the directory is wrong
     if (_parseTrace)
         cerr << "File to open: " << fullFilePath << endl;
-    _file.open(fullFilePath.c_str());
+    if (_file.open(fullFilePath))
+        _fileText = string_view(_file.getData(), _file.getSize());
     // New file, so output the trace header
-    if (_file.is_open() && _parseTrace)
+    if (isOpen() && _parseTrace)
+        outputPositionHeader();
+    return isOpen();
+}
+
+/* Parses text already in memory, instead of a file. The caller owns the
+    text, and it must stay valid until this object is closed */
+inline void XmlParser::openText(string_view text)
+{
+    if (isOpen())
+        close();
+    /* A view of nothing looks like a closed file, so point empty text at
+        something. It is never read */
+    if (text.data() == 0)
+        text = string_view("", 0);
+    _fileText = text;
+    if (_parseTrace)
         outputPositionHeader();
-    return _file.is_open();
 }
 
 // Resets object state for a new file
 inline void XmlParser::clearFileData(void)
 {
-  _buffer = "";
-  _nxtSrchPos = string::npos;
+  _buffer = string_view();
+  _nxtLinePos = 0;
+  _nxtSrchPos = string_view::npos;
 }
 
 #endif // Header not already included